@@ -2,13 +2,14 @@
 
 // === Circle constructors ===
 
-Body body_create_circle(Vec2 pos, float radius, float mass, float restitution) {
+Body body_create_circle(float radius, float mass, float restitution) {
     Body b;
-    b.position = pos;
-    b.velocity = VEC2_ZERO;
     b.mass = mass;
     b.inv_mass = (mass > 0.0f) ? (1.0f / mass) : 0.0f;
     b.restitution = restitution;
+    b.category = BODY_DEFAULT_CATEGORY;
+    b.mask = BODY_DEFAULT_MASK;
+    b.group = 0;
     b.color = (SDL_Color){255, 255, 255, 255};  // Default white
     
     // Shape
@@ -16,25 +17,24 @@ Body body_create_circle(Vec2 pos, float radius, float mass, float restitution) {
     b.shape.circle.radius = radius;
     
     // Rotational dynamics - circles use I = (1/2) * m * r^2
-    b.angle = 0.0f;
-    b.angular_velocity = 0.0f;
     float inertia = (mass > 0.0f) ? (0.5f * mass * radius * radius) : 0.0f;
     b.inv_inertia = (inertia > 0.0f) ? (1.0f / inertia) : 0.0f;
     
     return b;
 }
 
-Body body_default(Vec2 pos, float radius) {
-    return body_create_circle(pos, radius, 1.0f, 0.8f);
+Body body_default(float radius) {
+    return body_create_circle(radius, 1.0f, 0.8f);
 }
 
-Body body_create_static(Vec2 pos, float radius) {
+Body body_create_static(float radius) {
     Body b;
-    b.position = pos;
-    b.velocity = VEC2_ZERO;
     b.mass = 0.0f;
     b.inv_mass = 0.0f;
     b.restitution = 0.5f;
+    b.category = BODY_DEFAULT_CATEGORY;
+    b.mask = BODY_DEFAULT_MASK;
+    b.group = 0;
     b.color = (SDL_Color){100, 100, 100, 255};  // Gray for static
     
     // Shape
@@ -42,8 +42,6 @@ Body body_create_static(Vec2 pos, float radius) {
     b.shape.circle.radius = radius;
     
     // Static bodies don't rotate
-    b.angle = 0.0f;
-    b.angular_velocity = 0.0f;
     b.inv_inertia = 0.0f;
     
     return b;
@@ -51,13 +49,14 @@ Body body_create_static(Vec2 pos, float radius) {
 
 // === Rectangle constructors ===
 
-Body body_create_rect(Vec2 pos, float width, float height, float mass, float restitution) {
+Body body_create_rect(float width, float height, float mass, float restitution) {
     Body b;
-    b.position = pos;
-    b.velocity = VEC2_ZERO;
     b.mass = mass;
     b.inv_mass = (mass > 0.0f) ? (1.0f / mass) : 0.0f;
     b.restitution = restitution;
+    b.category = BODY_DEFAULT_CATEGORY;
+    b.mask = BODY_DEFAULT_MASK;
+    b.group = 0;
     b.color = (SDL_Color){255, 255, 255, 255};  // Default white
     
     // Shape
@@ -66,25 +65,24 @@ Body body_create_rect(Vec2 pos, float width, float height, float mass, float res
     b.shape.rect.height = height;
     
     // Rotational dynamics - rectangles use I = (1/12) * m * (w^2 + h^2)
-    b.angle = 0.0f;
-    b.angular_velocity = 0.0f;
     float inertia = (mass > 0.0f) ? ((1.0f / 12.0f) * mass * (width * width + height * height)) : 0.0f;
     b.inv_inertia = (inertia > 0.0f) ? (1.0f / inertia) : 0.0f;
     
     return b;
 }
 
-Body body_default_rect(Vec2 pos, float width, float height) {
-    return body_create_rect(pos, width, height, 1.0f, 0.8f);
+Body body_default_rect(float width, float height) {
+    return body_create_rect(width, height, 1.0f, 0.8f);
 }
 
-Body body_create_static_rect(Vec2 pos, float width, float height) {
+Body body_create_static_rect(float width, float height) {
     Body b;
-    b.position = pos;
-    b.velocity = VEC2_ZERO;
     b.mass = 0.0f;
     b.inv_mass = 0.0f;
     b.restitution = 0.5f;
+    b.category = BODY_DEFAULT_CATEGORY;
+    b.mask = BODY_DEFAULT_MASK;
+    b.group = 0;
     b.color = (SDL_Color){100, 100, 100, 255};  // Gray for static
     
     // Shape
@@ -93,8 +91,6 @@ Body body_create_static_rect(Vec2 pos, float width, float height) {
     b.shape.rect.height = height;
     
     // Static bodies don't rotate
-    b.angle = 0.0f;
-    b.angular_velocity = 0.0f;
     b.inv_inertia = 0.0f;
     
     return b;
@@ -108,6 +104,69 @@ void body_set_static(Body *b) {
     b->inv_inertia = 0.0f;
 }
 
-int body_is_static(const Body *b) {
-    return b->inv_mass == 0.0f;
+AABB body_get_aabb(const Body *b, Vec2 position, float angle) {
+    Vec2 half;
+    if (b->shape.type == SHAPE_CIRCLE) {
+        half = vec2(b->shape.circle.radius, b->shape.circle.radius);
+    } else {
+        // Rotated rect: project both half-axes onto world x and y
+        float c = fabsf(cosf(angle));
+        float s = fabsf(sinf(angle));
+        float half_w = b->shape.rect.width * 0.5f;
+        float half_h = b->shape.rect.height * 0.5f;
+        half = vec2(half_w * c + half_h * s, half_w * s + half_h * c);
+    }
+
+    AABB box;
+    box.min = vec2_sub(position, half);
+    box.max = vec2_add(position, half);
+    return box;
+}
+
+float body_bound_radius(const Body *b) {
+    if (b->shape.type == SHAPE_CIRCLE) return b->shape.circle.radius;
+    float half_w = b->shape.rect.width * 0.5f;
+    float half_h = b->shape.rect.height * 0.5f;
+    return sqrtf(half_w * half_w + half_h * half_h);   // Half diagonal: the corners at any angle
+}
+
+void body_compute_transform(const Body *b, Vec2 position, float angle, BodyTransform *xf) {
+    if (!xf->valid || xf->angle != angle) {
+        xf->angle = angle;
+        xf->cos_angle = cosf(angle);
+        xf->sin_angle = sinf(angle);
+        xf->axis_aligned = (angle == 0.0f);   // cos = 1 and sin = 0 exactly
+    }
+    xf->position = position;
+    xf->valid = 1;
+
+    Vec2 half;
+    if (b->shape.type == SHAPE_CIRCLE) {
+        half = vec2(b->shape.circle.radius, b->shape.circle.radius);
+    } else {
+        float c = xf->cos_angle;
+        float s = xf->sin_angle;
+        float half_w = b->shape.rect.width * 0.5f;
+        float half_h = b->shape.rect.height * 0.5f;
+
+        // Local corners (top-left, top-right, bottom-right, bottom-left)
+        Vec2 local[4] = {
+            vec2(-half_w, -half_h),
+            vec2( half_w, -half_h),
+            vec2( half_w,  half_h),
+            vec2(-half_w,  half_h)
+        };
+        for (int i = 0; i < 4; i++) {
+            float wx = local[i].x * c - local[i].y * s;
+            float wy = local[i].x * s + local[i].y * c;
+            xf->corners[i] = vec2_add(vec2(wx, wy), position);
+        }
+
+        float ac = fabsf(c);
+        float as = fabsf(s);
+        half = vec2(half_w * ac + half_h * as, half_w * as + half_h * ac);
+    }
+
+    xf->aabb.min = vec2_sub(position, half);
+    xf->aabb.max = vec2_add(position, half);
 }
@@ -4,6 +4,9 @@
 #include "vec2.h"
 #include <SDL.h>
 
+#define BODY_DEFAULT_CATEGORY 0x0001u
+#define BODY_DEFAULT_MASK 0xFFFFFFFFu   // Collide with every category
+
 // Shape type enum
 typedef enum {
     SHAPE_CIRCLE,
@@ -24,54 +27,100 @@ typedef struct {
     };
 } Shape;
 
+// The cold part of a body: mass, shape, filter and render data. Its position, velocity,
+// angle and angular velocity are hot state kept by World in per-field streams
+// (world_get_position and friends), given to world_add_body separately.
 typedef struct Body {
-    Vec2 position;           // Position in pixels (world coordinates)
-    Vec2 velocity;           // Velocity in pixels/second
-
     float mass;              // Mass in kilograms (kg). 0 = static/infinite mass
     float inv_mass;          // 1/mass for efficiency. 0 = static body
-    float restitution;       // Bounciness [0-1]. 0=no bounce, 1=perfect bounce
-
-    float angle;             // Rotation angle in radians
-    float angular_velocity;  // Angular velocity in radians/second
     float inv_inertia;       // 1/inertia for efficiency. 0 = static body
+    float restitution;       // Bounciness [0-1]. 0=no bounce, 1=perfect bounce
 
     Shape shape;
 
+    // Collision filtering, checked by the broadphase before any narrowphase work.
+    // Two bodies collide when each one's category is in the other's mask and they do
+    // not share a nonzero group.
+    unsigned int category;   // Category bits this body belongs to (default BODY_DEFAULT_CATEGORY)
+    unsigned int mask;       // Categories this body collides with (default BODY_DEFAULT_MASK)
+    int group;               // Bodies with the same nonzero group never collide (default 0)
+
     SDL_Color color;
 } Body;
 
+// Axis-aligned bounding box in world coordinates (pixels)
+typedef struct {
+    Vec2 min;
+    Vec2 max;
+} AABB;
+
+// Pose-derived data that the narrowphase would otherwise recompute for every pair.
+// Owned by World (see world_get_transform), refreshed when position or angle changes.
+typedef struct {
+    Vec2 position;       // Pose the cache was computed for
+    float angle;
+    float cos_angle;     // Rotation matrix [cos -sin; sin cos]
+    float sin_angle;
+    Vec2 corners[4];     // Rect corners in world space (TL, TR, BR, BL); unused for circles
+    AABB aabb;           // Same box as body_get_aabb
+    int axis_aligned;    // angle == 0: local axes are the world axes (narrowphase fast paths)
+    int valid;           // 0 = never computed
+} BodyTransform;
 
 // === Circle constructors ===
 
 // Create a dynamic circle body with given properties (full control)
-Body body_create_circle(Vec2 pos, float radius, float mass, float restitution);
+Body body_create_circle(float radius, float mass, float restitution);
 
 // Create a circle body with sensible defaults (mass=1, restitution=0.8, white color)
 // This is the preferred constructor for most use cases
-Body body_default(Vec2 pos, float radius);
+Body body_default(float radius);
 
 // Create a static (immovable) circle body
-Body body_create_static(Vec2 pos, float radius);
+Body body_create_static(float radius);
 
 // === Rectangle constructors ===
 
 // Create a dynamic rectangle body with given properties (full control)
 // Computes moment of inertia: I = (1/12) * mass * (width^2 + height^2)
-Body body_create_rect(Vec2 pos, float width, float height, float mass, float restitution);
+Body body_create_rect(float width, float height, float mass, float restitution);
 
 // Create a rectangle body with sensible defaults (mass=1, restitution=0.8, white color)
-Body body_default_rect(Vec2 pos, float width, float height);
+Body body_default_rect(float width, float height);
 
 // Create a static (immovable) rectangle body
-Body body_create_static_rect(Vec2 pos, float width, float height);
+Body body_create_static_rect(float width, float height);
 
 // === Common functions ===
 
 // Make an existing body static (sets inv_mass = 0, inv_inertia = 0)
 void body_set_static(Body *b);
 
-// Check if body is static (inv_mass == 0)
-int body_is_static(const Body *b);
+// Check if body is static (inv_mass == 0). Inline: every per-body loop of the step asks.
+static inline int body_is_static(const Body *b) {
+    return b->inv_mass == 0.0f;
+}
+
+// Compute the world-space AABB of a body at the given pose (accounts for rect rotation)
+AABB body_get_aabb(const Body *b, Vec2 position, float angle);
+
+// Distance from the center to the farthest point of the shape, at any angle
+float body_bound_radius(const Body *b);
+
+// Bring a transform cache up to date with the body's pose.
+// Trig is only recomputed when the angle changed since the last call.
+void body_compute_transform(const Body *b, Vec2 position, float angle, BodyTransform *xf);
+
+// Returns 1 if the two boxes overlap (touching counts as overlap)
+static inline int aabb_overlap(const AABB *a, const AABB *b) {
+    return a->min.x <= b->max.x && a->max.x >= b->min.x &&
+           a->min.y <= b->max.y && a->max.y >= b->min.y;
+}
+
+// Returns 1 if the collision filters of a and b allow them to touch
+static inline int body_should_collide(const Body *a, const Body *b) {
+    if (a->group != 0 && a->group == b->group) return 0;
+    return (a->category & b->mask) != 0 && (b->category & a->mask) != 0;
+}
 
 #endif // BODY_H
@@ -0,0 +1,375 @@
+#include "world.h"  // Pulls in broadphase.h
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// --- Pair list helpers ---
+
+// Make room for `needed` pairs in w->pairs. Returns -1 if out of memory.
+static int reserve_pairs(World *w, int needed) {
+    if (needed <= w->pair_capacity) return 0;
+    int capacity = (w->pair_capacity > 0) ? w->pair_capacity : BROADPHASE_PAIRS_INITIAL;
+    while (capacity < needed) capacity *= 2;
+    BodyPair *pairs = (BodyPair *)realloc(w->pairs, (size_t)capacity * sizeof(BodyPair));
+    if (!pairs) return -1;
+    w->pairs = pairs;
+    w->pair_capacity = capacity;
+    return 0;
+}
+
+void broadphase_add_pair(World *w, int i, int j) {
+    if (!body_should_collide(&w->bodies[i], &w->bodies[j])) return;  // Filtered out by layers/groups
+    if (reserve_pairs(w, w->pair_count + 1) != 0) return;  // Out of memory: drop the pair
+    BodyPair *p = &w->pairs[w->pair_count++];
+    p->a = (i < j) ? i : j;
+    p->b = (i < j) ? j : i;
+}
+
+void pair_buffer_add(PairBuffer *buf, const World *w, int i, int j) {
+    if (!body_should_collide(&w->bodies[i], &w->bodies[j])) return;
+    if (buf->count >= buf->capacity) {
+        int capacity = (buf->capacity > 0) ? 2 * buf->capacity : BROADPHASE_PAIRS_INITIAL;
+        BodyPair *pairs = (BodyPair *)realloc(buf->pairs, (size_t)capacity * sizeof(BodyPair));
+        if (!pairs) return;  // Out of memory: drop the pair
+        buf->pairs = pairs;
+        buf->capacity = capacity;
+    }
+    BodyPair *p = &buf->pairs[buf->count++];
+    p->a = (i < j) ? i : j;
+    p->b = (i < j) ? j : i;
+}
+
+void broadphase_merge_thread_pairs(World *w) {
+    for (int t = 0; t < task_pool_thread_count(w->tasks); t++) {
+        PairBuffer *buf = &w->thread_pairs[t];
+        if (buf->count > 0 && reserve_pairs(w, w->pair_count + buf->count) == 0) {
+            memcpy(w->pairs + w->pair_count, buf->pairs, (size_t)buf->count * sizeof(BodyPair));
+            w->pair_count += buf->count;
+        }
+        buf->count = 0;
+    }
+}
+
+static int compare_pairs(const void *lhs, const void *rhs) {
+    const BodyPair *p = (const BodyPair *)lhs;
+    const BodyPair *q = (const BodyPair *)rhs;
+    if (p->a != q->a) return p->a - q->a;
+    return p->b - q->b;
+}
+
+void broadphase_sort_pairs(BodyPair *pairs, int count) {
+    if (count > 1) qsort(pairs, (size_t)count, sizeof(BodyPair), compare_pairs);
+}
+
+AABB broadphase_padded_aabb(World *w, int index) {
+    AABB box = world_get_transform(w, index)->aabb;
+    box.min = vec2_sub(box.min, vec2(BROADPHASE_MARGIN, BROADPHASE_MARGIN));
+    box.max = vec2_add(box.max, vec2(BROADPHASE_MARGIN, BROADPHASE_MARGIN));
+    return box;
+}
+
+// --- Uniform spatial hash ---
+
+static unsigned int spatial_hash_bucket(const SpatialHash *g, int cx, int cy) {
+    // Large primes spread neighbouring cells across buckets
+    return (((unsigned int)cx * 73856093u) ^ ((unsigned int)cy * 19349663u)) & (unsigned int)(g->bucket_count - 1);
+}
+
+// Auto cell size: 2x the mean extent of dynamic bodies, so a typical body covers 1-4 cells.
+// Statics are not in the grid, so huge walls cannot blow up the cell size.
+static float spatial_hash_auto_cell_size(World *w) {
+    const StaticIndex *si = &w->statics;
+    float sum = 0.0f;
+    for (int k = 0; k < si->dynamic_count; k++) {
+        AABB box = world_get_transform(w, si->dynamic_bodies[k])->aabb;
+        sum += fmaxf(box.max.x - box.min.x, box.max.y - box.min.y);
+    }
+    float size = (si->dynamic_count > 0) ? 2.0f * sum / si->dynamic_count : 0.0f;
+    return (size > 1.0f) ? size : 64.0f;
+}
+
+// Pairs sharing a cell, for entries [first, last): each entry is compared with the
+// entries after it in its bucket chain. A pair can share several cells; only report it
+// from the first shared cell (max of both min corners) so no dedup table is needed.
+// Pairs go to `out`, or straight to w->pairs when out is NULL.
+static void spatial_hash_cell_pairs(World *w, int first, int last, PairBuffer *out) {
+    const SpatialHash *g = &w->spatial_hash;
+    for (int e = first; e < last; e++) {
+        const SpatialHashEntry *ea = &g->entries[e];
+        for (int f = ea->next; f != -1; f = g->entries[f].next) {
+            const SpatialHashEntry *eb = &g->entries[f];
+            if (ea->cx != eb->cx || ea->cy != eb->cy) continue;  // Hash collision, different cell
+
+            int i = ea->body;
+            int j = eb->body;
+            int first_cx = (g->min_cx[i] > g->min_cx[j]) ? g->min_cx[i] : g->min_cx[j];
+            int first_cy = (g->min_cy[i] > g->min_cy[j]) ? g->min_cy[i] : g->min_cy[j];
+            if (ea->cx != first_cx || ea->cy != first_cy) continue;
+
+            if (aabb_overlap(&g->aabbs[i], &g->aabbs[j])) {
+                if (out) pair_buffer_add(out, w, i, j); else broadphase_add_pair(w, i, j);
+            }
+        }
+    }
+}
+
+static void spatial_hash_pairs_task(void *context, int task, int thread) {
+    World *w = (World *)context;
+    int first = task * BROADPHASE_TASK_ENTRIES;
+    int last = first + BROADPHASE_TASK_ENTRIES;
+    if (last > w->spatial_hash.entry_count) last = w->spatial_hash.entry_count;
+    spatial_hash_cell_pairs(w, first, last, &w->thread_pairs[thread]);
+}
+
+static void spatial_hash_update(World *w) {
+    SpatialHash *g = &w->spatial_hash;
+    float cell_size = (g->cell_size > 0.0f) ? g->cell_size : spatial_hash_auto_cell_size(w);
+    float inv_cell = 1.0f / cell_size;
+
+    // Empty only the buckets used last step; tiny scenes never touch the full table
+    for (int e = 0; e < g->entry_count; e++) {
+        g->head[spatial_hash_bucket(g, g->entries[e].cx, g->entries[e].cy)] = -1;
+    }
+    g->entry_count = 0;
+    g->oversize_count = 0;
+
+    // Insert every dynamic body into each cell its padded AABB covers
+    const StaticIndex *si = &w->statics;
+    for (int k = 0; k < si->dynamic_count; k++) {
+        int i = si->dynamic_bodies[k];
+        AABB box = broadphase_padded_aabb(w, i);
+        g->aabbs[i] = box;
+
+        int min_cx = (int)floorf(box.min.x * inv_cell);
+        int min_cy = (int)floorf(box.min.y * inv_cell);
+        int max_cx = (int)floorf(box.max.x * inv_cell);
+        int max_cy = (int)floorf(box.max.y * inv_cell);
+        g->min_cx[i] = min_cx;
+        g->min_cy[i] = min_cy;
+
+        int cells = (max_cx - min_cx + 1) * (max_cy - min_cy + 1);
+        if (cells > SPATIAL_HASH_MAX_CELLS || g->entry_count + cells > g->entry_capacity) {
+            g->oversize[g->oversize_count++] = i;
+            g->min_cx[i] = INT32_MIN;  // Marks body as oversize
+            continue;
+        }
+
+        for (int cy = min_cy; cy <= max_cy; cy++) {
+            for (int cx = min_cx; cx <= max_cx; cx++) {
+                unsigned int bucket = spatial_hash_bucket(g, cx, cy);
+                SpatialHashEntry *e = &g->entries[g->entry_count];
+                e->body = i;
+                e->cx = cx;
+                e->cy = cy;
+                e->next = g->head[bucket];
+                g->head[bucket] = g->entry_count++;
+            }
+        }
+    }
+
+    // Pairs sharing a cell (split across the world's threads when it has several)
+    if (w->tasks) {
+        int tasks = (g->entry_count + BROADPHASE_TASK_ENTRIES - 1) / BROADPHASE_TASK_ENTRIES;
+        task_pool_run(w->tasks, spatial_hash_pairs_task, w, tasks);
+        broadphase_merge_thread_pairs(w);
+    } else {
+        spatial_hash_cell_pairs(w, 0, g->entry_count, NULL);
+    }
+
+    // Oversize bodies are tested against every dynamic body (each oversize-oversize pair once)
+    for (int k = 0; k < g->oversize_count; k++) {
+        int i = g->oversize[k];
+        for (int m = 0; m < si->dynamic_count; m++) {
+            int j = si->dynamic_bodies[m];
+            if (j == i) continue;
+            if (g->min_cx[j] == INT32_MIN && j < i) continue;
+            if (aabb_overlap(&g->aabbs[i], &g->aabbs[j])) {
+                broadphase_add_pair(w, i, j);
+            }
+        }
+    }
+}
+
+// --- Public API ---
+
+// Smallest power of two >= BROADPHASE_BUCKETS_PER_BODY * capacity
+static int bucket_count_for(int capacity) {
+    int count = 1;
+    while (count < BROADPHASE_BUCKETS_PER_BODY * capacity) count *= 2;
+    return count;
+}
+
+void broadphase_init(World *w) {
+    SpatialHash *g = &w->spatial_hash;
+    if (g->head) memset(g->head, 0xff, (size_t)g->bucket_count * sizeof(int));  // All buckets empty (-1)
+    g->entry_count = 0;
+    g->oversize_count = 0;
+    sap_init(&w->sap);
+    aabb_tree_init(&w->aabb_tree);
+    hgrid_init(&w->hgrid);
+    w->statics.built_body_count = -1;
+    w->statics.dynamic_count = 0;
+    w->statics.static_count = 0;
+    w->pair_count = 0;
+}
+
+int broadphase_reserve(World *w, int capacity) {
+    int failed = 0;
+    int buckets = bucket_count_for(capacity);
+
+    SpatialHash *g = &w->spatial_hash;
+    RESIZE_ARRAY(g->aabbs, capacity, failed);
+    RESIZE_ARRAY(g->min_cx, capacity, failed);
+    RESIZE_ARRAY(g->min_cy, capacity, failed);
+    RESIZE_ARRAY(g->oversize, capacity, failed);
+    RESIZE_ARRAY(g->entries, SPATIAL_HASH_ENTRIES_PER_BODY * capacity, failed);
+    if (!failed) g->entry_capacity = SPATIAL_HASH_ENTRIES_PER_BODY * capacity;
+    if (buckets > g->bucket_count) {
+        RESIZE_ARRAY(g->head, buckets, failed);
+        if (!failed) {
+            // Entries hash differently with the new mask: start from an empty grid
+            g->bucket_count = buckets;
+            memset(g->head, 0xff, (size_t)buckets * sizeof(int));
+            g->entry_count = 0;
+        }
+    }
+
+    SweepAndPrune *sap = &w->sap;
+    RESIZE_ARRAY(sap->endpoints[0], 2 * capacity, failed);
+    RESIZE_ARRAY(sap->endpoints[1], 2 * capacity, failed);
+    RESIZE_ARRAY(sap->aabbs, capacity, failed);
+    RESIZE_ARRAY(sap->active, capacity, failed);
+
+    if (aabb_tree_reserve(&w->aabb_tree, capacity) != 0) failed = 1;
+
+    HierarchicalGrid *hg = &w->hgrid;
+    RESIZE_ARRAY(hg->entries, capacity, failed);
+    RESIZE_ARRAY(hg->aabbs, capacity, failed);
+    RESIZE_ARRAY(hg->oversize, capacity, failed);
+    if (buckets > hg->bucket_count) {
+        RESIZE_ARRAY(hg->head, buckets, failed);
+        if (!failed) {
+            hg->bucket_count = buckets;
+            memset(hg->head, 0xff, (size_t)buckets * sizeof(int));
+            hg->entry_count = 0;
+        }
+    }
+
+    StaticIndex *si = &w->statics;
+    RESIZE_ARRAY(si->dynamic_bodies, capacity, failed);
+    RESIZE_ARRAY(si->cache_box, capacity, failed);
+    RESIZE_ARRAY(si->cache, capacity, failed);
+    RESIZE_ARRAY(si->cache_count, capacity, failed);
+    RESIZE_ARRAY(si->query, capacity, failed);
+    if (aabb_tree_reserve(&si->tree, capacity) != 0) failed = 1;
+
+    return failed ? -1 : 0;
+}
+
+void broadphase_destroy(World *w) {
+    SpatialHash *g = &w->spatial_hash;
+    free(g->head);
+    free(g->entries);
+    free(g->aabbs);
+    free(g->min_cx);
+    free(g->min_cy);
+    free(g->oversize);
+    memset(g, 0, sizeof(*g));
+
+    sap_destroy(&w->sap);
+    aabb_tree_destroy(&w->aabb_tree);
+
+    HierarchicalGrid *hg = &w->hgrid;
+    free(hg->head);
+    free(hg->entries);
+    free(hg->aabbs);
+    free(hg->oversize);
+    memset(hg, 0, sizeof(*hg));
+
+    StaticIndex *si = &w->statics;
+    free(si->dynamic_bodies);
+    free(si->cache_box);
+    free(si->cache);
+    free(si->cache_count);
+    free(si->query);
+    aabb_tree_destroy(&si->tree);
+    memset(si, 0, sizeof(*si));
+    si->built_body_count = -1;
+}
+
+void broadphase_remap_bodies(World *w, const int *to) {
+    // The grids are rebuilt from scratch every step; only SAP and the tree persist
+    sap_remap(&w->sap, to);
+    aabb_tree_remap(&w->aabb_tree, to);
+    static_pairs_invalidate(w);
+    w->pair_count = 0;
+}
+
+int broadphase_update(World *w) {
+    StaticIndex *si = &w->statics;
+    if (si->built_body_count != w->body_count) {
+        broadphase_build_statics(w);  // Bodies added after load
+    }
+
+    switch (w->broadphase) {
+        case BROADPHASE_SPATIAL_HASH:
+            w->pair_count = 0;
+            spatial_hash_update(w);
+            static_pairs_update(w);
+            static_pairs_emit(w);
+            broadphase_sort_pairs(w->pairs, w->pair_count);
+            break;
+        case BROADPHASE_SAP: {
+            // Only republish when the dynamic or the static pair set changed
+            sap_update(w);
+            int statics_changed = static_pairs_update(w);
+            if ((w->sap.dirty || statics_changed) && reserve_pairs(w, w->sap.pair_count) == 0) {
+                if (w->sap.pair_count > 0) {
+                    memcpy(w->pairs, w->sap.pairs, (size_t)w->sap.pair_count * sizeof(BodyPair));
+                }
+                w->pair_count = w->sap.pair_count;
+                static_pairs_emit(w);
+                broadphase_sort_pairs(w->pairs, w->pair_count);
+                w->sap.dirty = 0;
+            }
+            break;
+        }
+        case BROADPHASE_AABB_TREE:
+            w->pair_count = 0;
+            aabb_tree_update(w);
+            static_pairs_update(w);
+            static_pairs_emit(w);
+            broadphase_sort_pairs(w->pairs, w->pair_count);
+            break;
+        case BROADPHASE_HGRID:
+            w->pair_count = 0;
+            hgrid_update(w);
+            static_pairs_update(w);
+            static_pairs_emit(w);
+            broadphase_sort_pairs(w->pairs, w->pair_count);
+            break;
+        case BROADPHASE_BRUTE_FORCE:
+        default: {
+            // No list: the narrowphase walks every pair except static-static (and filtered ones)
+            w->pair_count = 0;
+            long long n = w->body_count;
+            long long s = si->static_count;
+            long long pairs = n * (n - 1) / 2 - s * (s - 1) / 2;
+            return (pairs < INT32_MAX) ? (int)pairs : INT32_MAX;
+        }
+    }
+
+    return w->pair_count;
+}
+
+const char *broadphase_name(BroadphaseType type) {
+    switch (type) {
+        case BROADPHASE_BRUTE_FORCE:  return "brute_force";
+        case BROADPHASE_SPATIAL_HASH: return "spatial_hash";
+        case BROADPHASE_SAP:          return "sap";
+        case BROADPHASE_AABB_TREE:    return "aabb_tree";
+        case BROADPHASE_HGRID:        return "hgrid";
+        default:                      return "unknown";
+    }
+}
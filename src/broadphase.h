@@ -0,0 +1,235 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+// Broadphase: cheap AABB-level culling that turns the O(n²) set of body pairs
+// into a short list of candidate pairs for the narrowphase (collision.c).
+// Static bodies never respond to each other, so they live in their own tree
+// (StaticIndex) and only dynamic bodies go through the selected broadphase.
+// Per-body storage below is heap allocated for the world's body capacity
+// (broadphase_reserve); pair storage grows on demand.
+
+#include "body.h"
+
+// Forward declaration to avoid circular include
+typedef struct World World;
+
+#define BROADPHASE_PAIRS_INITIAL 64   // First pair buffer allocation; pair buffers double when full
+#define BROADPHASE_MARGIN 2.0f        // AABB padding in pixels so pairs survive solver position corrections
+#define BROADPHASE_BUCKETS_PER_BODY 4 // Hash grid buckets per body of capacity (rounded up to a power of two)
+#define BROADPHASE_TASK_ENTRIES 256   // Grid entries per task when the grid pair search runs on several threads
+
+typedef enum {
+    BROADPHASE_BRUTE_FORCE,    // Test every body pair (reference implementation)
+    BROADPHASE_SPATIAL_HASH,   // Uniform hash grid rebuilt from AABBs each step
+    BROADPHASE_SAP,            // Incremental sweep and prune with a persistent pair set
+    BROADPHASE_AABB_TREE,      // Dynamic AABB tree (BVH) with fattened leaves
+    BROADPHASE_HGRID,          // Hierarchical grid: one level per body size class
+    BROADPHASE_COUNT
+} BroadphaseType;
+
+// Candidate pair of body indices (a < b)
+typedef struct {
+    int a;
+    int b;
+} BodyPair;
+
+// Pairs found by one thread during a parallel pair search (see world_set_threads).
+// Merged into w->pairs before sorting, so the order threads found them in does not matter.
+typedef struct {
+    BodyPair *pairs;
+    int count;
+    int capacity;
+} PairBuffer;
+
+// --- Uniform spatial hash ---
+#define SPATIAL_HASH_MAX_CELLS 16          // Bodies covering more cells skip the grid and are tested against all
+#define SPATIAL_HASH_ENTRIES_PER_BODY 4    // Entry storage per body of capacity; bodies that do not fit go oversize
+
+typedef struct {
+    int body;    // Body index
+    int cx, cy;  // Cell coordinates (buckets can hold several cells)
+    int next;    // Next entry in the same bucket, -1 = end
+} SpatialHashEntry;
+
+typedef struct {
+    float cell_size;     // Cell edge length in pixels. 0 = auto (2x mean dynamic body extent)
+    int *head;           // First entry per bucket, -1 = empty
+    int bucket_count;    // Power of two
+    SpatialHashEntry *entries;
+    int entry_count;
+    int entry_capacity;
+
+    AABB *aabbs;         // Per body: padded AABB from the last rebuild
+    int *min_cx;         // Per body: first covered cell (used to report each pair once)
+    int *min_cy;
+    int *oversize;       // Bodies too large for the grid
+    int oversize_count;
+} SpatialHash;
+
+// --- Incremental sweep and prune ---
+
+typedef struct {
+    float value;   // Endpoint coordinate on this axis
+    int id;        // (body index << 1) | 1 for max endpoints, 0 for min
+} SapEndpoint;
+
+typedef struct {
+    SapEndpoint *endpoints[2];   // 2 per body of capacity, kept sorted on x and y across steps
+    AABB *aabbs;                 // Per body: padded AABB of the current step
+    int body_count;              // Dynamic bodies in the endpoint arrays (mismatch = full rebuild)
+
+    // Persistent set of overlapping pairs (unordered) with an open-addressing index
+    BodyPair *pairs;
+    int pair_count;
+    int pair_capacity;           // Grows by doubling; the table is twice as large
+    int *table;                  // Index into pairs, -1 = empty slot
+    int dirty;                   // Pair set changed since last copy to w->pairs
+    int *active;                 // Scratch, per body: boxes open on x during a rebuild sweep
+} SweepAndPrune;
+
+// --- Dynamic AABB tree ---
+#define AABB_TREE_NULL -1
+#define AABB_TREE_FAT_MARGIN 8.0f        // Leaf boxes are grown by this much (pixels); bodies reinsert only on escape
+
+typedef struct {
+    AABB box;       // Fat body box for leaves, union of children for internal nodes
+    int parent;     // Parent node, or next free node while on the free list
+    int child1;     // AABB_TREE_NULL for leaves
+    int child2;
+    int height;     // 0 for leaves, -1 for free nodes
+    int body;       // Body index (leaves only)
+} AabbTreeNode;
+
+typedef struct {
+    AabbTreeNode *nodes;        // 2 per body of capacity (n leaves need at most 2n - 1 nodes)
+    int node_capacity;
+    int root;
+    int free_list;
+    int *leaf;                  // Per body: its leaf node
+    int proxy_count;            // Dynamic bodies inserted so far (mismatch = insert the rest / rebuild)
+    AABB *aabbs;                // Per body: tight padded AABB of the current step
+    int reinserts;              // Leaves moved this step (diagnostics)
+} AabbTree;
+
+// --- Hierarchical grid ---
+#define HGRID_LEVELS 16             // Level L cells are base_cell_size * 2^L wide
+
+typedef struct {
+    int body;
+    int level;
+    int cx, cy;  // Cell holding the body's AABB center at its level
+    int next;    // Next entry in the same bucket, -1 = end
+} HGridEntry;
+
+typedef struct {
+    float base_cell_size;        // Level 0 cell edge: 2x the smallest dynamic body extent this step
+    unsigned int occupied;       // Bit L set = some body lives on level L
+    int *head;                   // First entry per bucket, -1 = empty
+    int bucket_count;            // Power of two
+    HGridEntry *entries;         // One entry per body (bodies live in a single cell)
+    int entry_count;
+
+    AABB *aabbs;                 // Per body: padded AABB from the last rebuild
+    int *oversize;               // Bodies larger than the top level's cells
+    int oversize_count;
+} HierarchicalGrid;
+
+// --- Static bodies ---
+#define STATIC_CACHE_SLOTS 8        // Statics remembered per dynamic body
+#define STATIC_CACHE_MARGIN 8.0f    // Query box growth (pixels); a cached list stays valid until the body leaves it
+
+typedef struct {
+    int built_body_count;               // w->body_count at build time; mismatch = rebuild, -1 = never built
+    int *dynamic_bodies;                // Non-static body indices, ascending (fed to the broadphase)
+    int dynamic_count;
+    int static_count;
+    AabbTree tree;                      // Static bodies only; built once, never refit
+
+    // Dynamic-static pairs cached per dynamic body: statics overlapping cache_box
+    AABB *cache_box;
+    int (*cache)[STATIC_CACHE_SLOTS];
+    int *cache_count;                   // -1 = must query (stale, or too many statics to cache)
+    int dirty;                          // Some cached list changed since the pair list was published
+    int *query;                         // Scratch, per body: fresh query results for uncacheable bodies
+} StaticIndex;
+
+// Reset all broadphase state (called by world_init and when switching broadphase)
+void broadphase_init(World *w);
+
+// Size the per-body storage for `capacity` bodies (called by world_reserve_bodies).
+// Returns -1 if out of memory (buffers that already grew are kept).
+int broadphase_reserve(World *w, int capacity);
+
+// Free all broadphase storage (called by world_destroy)
+void broadphase_destroy(World *w);
+
+// Rebuild candidate pairs for the current body poses into w->pairs.
+// Pairs are sorted by (a, b) so the solver visits them in the same order as brute force.
+// Returns the number of candidate pairs (brute force builds no list and returns the number
+// of pairs it will test: every pair except static-static).
+int broadphase_update(World *w);
+
+// Split bodies into dynamic and static and build the static tree.
+// Called by scene_load; broadphase_update rebuilds it if bodies were added since.
+void broadphase_build_statics(World *w);
+
+// Bodies moved to new indices (to[old] = new, see world_reorder_bodies): carry the
+// persistent broadphase state over instead of rebuilding it. Dynamic bodies must only
+// trade places with each other.
+void broadphase_remap_bodies(World *w, const int *to);
+
+// Human-readable name for logs and benchmarks
+const char *broadphase_name(BroadphaseType type);
+
+// --- Shared by the broadphase implementations ---
+
+// Cached AABB of body `index` padded by BROADPHASE_MARGIN
+AABB broadphase_padded_aabb(World *w, int index);
+
+// Append pair (i, j) to w->pairs as (min, max), growing the buffer as needed; dropped when
+// out of memory or when the bodies' collision filters keep them apart (body_should_collide)
+void broadphase_add_pair(World *w, int i, int j);
+
+// Same as broadphase_add_pair, into a thread's own buffer during a parallel pass
+void pair_buffer_add(PairBuffer *buf, const World *w, int i, int j);
+
+// Append every thread's buffer to w->pairs and empty them
+void broadphase_merge_thread_pairs(World *w);
+
+// Sort pairs by (a, b) for a deterministic solver order
+void broadphase_sort_pairs(BodyPair *pairs, int count);
+
+// Sweep and prune (broadphase_sap.c)
+void sap_init(SweepAndPrune *sap);
+void sap_update(World *w);
+void sap_remap(SweepAndPrune *sap, const int *to);
+void sap_destroy(SweepAndPrune *sap);
+
+// Dynamic AABB tree (broadphase_tree.c)
+void aabb_tree_init(AabbTree *tree);
+void aabb_tree_update(World *w);
+void aabb_tree_remap(AabbTree *tree, const int *to);
+// Room for `body_capacity` leaves (node pool and per-body arrays). Returns -1 if out of memory.
+int aabb_tree_reserve(AabbTree *tree, int body_capacity);
+void aabb_tree_destroy(AabbTree *tree);
+
+// Insert a leaf for `body` with exactly `box` (no fattening, used by the static tree)
+void aabb_tree_insert(AabbTree *tree, int body, const AABB *box);
+
+// Collect bodies whose leaf boxes overlap `box` into out (up to max).
+// Returns the total number found, which may exceed max.
+int aabb_tree_query(const AabbTree *tree, const AABB *box, int *out, int max);
+
+// Hierarchical grid (broadphase_hgrid.c)
+void hgrid_init(HierarchicalGrid *grid);
+void hgrid_update(World *w);
+
+// Static bodies (broadphase_static.c)
+// Refresh per-body caches; returns 1 if any dynamic-static pair set changed
+int static_pairs_update(World *w);
+// Append every cached dynamic-static pair to w->pairs
+void static_pairs_emit(World *w);
+// Forget the per-body caches (re-queried by the next update)
+void static_pairs_invalidate(World *w);
+
+#endif // BROADPHASE_H
@@ -0,0 +1,151 @@
+#include "world.h"  // Pulls in broadphase.h
+#include <math.h>
+
+// Hierarchical grid.
+// A single cell size fits badly when body extents span orders of magnitude: small
+// cells make big bodies cover hundreds of cells, big cells put many small bodies in one.
+// Here each body goes into exactly one cell (by its AABB center) on the finest level
+// whose cells are at least as wide as the body. Two overlapping bodies both fit in the
+// coarser body's cells, so their centers are at most one cell apart on that level:
+// each body only checks the 3x3 cells around it on its own level and every coarser one.
+
+static unsigned int hgrid_bucket(const HierarchicalGrid *g, int level, int cx, int cy) {
+    return (((unsigned int)cx * 73856093u) ^ ((unsigned int)cy * 19349663u) ^
+            ((unsigned int)level * 83492791u)) & (unsigned int)(g->bucket_count - 1);
+}
+
+static float extent(const AABB *box) {
+    return fmaxf(box->max.x - box->min.x, box->max.y - box->min.y);
+}
+
+void hgrid_init(HierarchicalGrid *grid) {
+    for (int b = 0; b < grid->bucket_count; b++) grid->head[b] = -1;
+    grid->entry_count = 0;
+    grid->oversize_count = 0;
+    grid->occupied = 0;
+    grid->base_cell_size = 0.0f;
+}
+
+// Pairs for entries [first, last): each body looks up its own level and every occupied
+// coarser one. A pair on two different levels is found once, from the finer body;
+// same-level pairs are reported by the lower body index only.
+// Pairs go to `out`, or straight to w->pairs when out is NULL.
+static void hgrid_cell_pairs(World *w, int first, int last, PairBuffer *out) {
+    const HierarchicalGrid *g = &w->hgrid;
+    for (int e = first; e < last; e++) {
+        const HGridEntry *ea = &g->entries[e];
+        int i = ea->body;
+        float cx_center = 0.5f * (g->aabbs[i].min.x + g->aabbs[i].max.x);
+        float cy_center = 0.5f * (g->aabbs[i].min.y + g->aabbs[i].max.y);
+        float cell = g->base_cell_size * (float)(1u << ea->level);
+
+        for (int level = ea->level; level < HGRID_LEVELS; level++, cell *= 2.0f) {
+            if (!(g->occupied >> level)) break;  // Nothing coarser
+            if (!(g->occupied & (1u << level))) continue;
+
+            int cx = (level == ea->level) ? ea->cx : (int)floorf(cx_center / cell);
+            int cy = (level == ea->level) ? ea->cy : (int)floorf(cy_center / cell);
+            for (int y = cy - 1; y <= cy + 1; y++) {
+                for (int x = cx - 1; x <= cx + 1; x++) {
+                    for (int f = g->head[hgrid_bucket(g, level, x, y)]; f != -1; f = g->entries[f].next) {
+                        const HGridEntry *eb = &g->entries[f];
+                        if (eb->level != level || eb->cx != x || eb->cy != y) continue;  // Hash collision
+                        int j = eb->body;
+                        if (level == ea->level && j <= i) continue;
+                        if (aabb_overlap(&g->aabbs[i], &g->aabbs[j])) {
+                            if (out) pair_buffer_add(out, w, i, j); else broadphase_add_pair(w, i, j);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void hgrid_pairs_task(void *context, int task, int thread) {
+    World *w = (World *)context;
+    int first = task * BROADPHASE_TASK_ENTRIES;
+    int last = first + BROADPHASE_TASK_ENTRIES;
+    if (last > w->hgrid.entry_count) last = w->hgrid.entry_count;
+    hgrid_cell_pairs(w, first, last, &w->thread_pairs[thread]);
+}
+
+void hgrid_update(World *w) {
+    HierarchicalGrid *g = &w->hgrid;
+    const StaticIndex *si = &w->statics;
+
+    // Empty only the buckets used last step
+    for (int e = 0; e < g->entry_count; e++) {
+        const HGridEntry *entry = &g->entries[e];
+        g->head[hgrid_bucket(g, entry->level, entry->cx, entry->cy)] = -1;
+    }
+    g->entry_count = 0;
+    g->oversize_count = 0;
+    g->occupied = 0;
+
+    // Level 0 cells are twice the smallest body (a few small bodies per cell);
+    // every level above doubles the cell size
+    float base = 0.0f;
+    for (int k = 0; k < si->dynamic_count; k++) {
+        int i = si->dynamic_bodies[k];
+        g->aabbs[i] = broadphase_padded_aabb(w, i);
+        float size = extent(&g->aabbs[i]);
+        if (k == 0 || size < base) base = size;
+    }
+    base *= 2.0f;
+    if (base < 1.0f) base = 1.0f;
+    g->base_cell_size = base;
+
+    for (int k = 0; k < si->dynamic_count; k++) {
+        int i = si->dynamic_bodies[k];
+        const AABB *box = &g->aabbs[i];
+        float size = extent(box);
+
+        int level = 0;
+        float cell = base;
+        while (cell < size && level < HGRID_LEVELS - 1) {
+            cell *= 2.0f;
+            level++;
+        }
+        if (cell < size) {
+            g->oversize[g->oversize_count++] = i;
+            continue;
+        }
+
+        HGridEntry *entry = &g->entries[g->entry_count];
+        entry->body = i;
+        entry->level = level;
+        entry->cx = (int)floorf(0.5f * (box->min.x + box->max.x) / cell);
+        entry->cy = (int)floorf(0.5f * (box->min.y + box->max.y) / cell);
+        unsigned int bucket = hgrid_bucket(g, level, entry->cx, entry->cy);
+        entry->next = g->head[bucket];
+        g->head[bucket] = g->entry_count++;
+        g->occupied |= 1u << level;
+    }
+
+    // Cell pairs (split across the world's threads when it has several)
+    if (w->tasks) {
+        int tasks = (g->entry_count + BROADPHASE_TASK_ENTRIES - 1) / BROADPHASE_TASK_ENTRIES;
+        task_pool_run(w->tasks, hgrid_pairs_task, w, tasks);
+        broadphase_merge_thread_pairs(w);
+    } else {
+        hgrid_cell_pairs(w, 0, g->entry_count, NULL);
+    }
+
+    // Bodies too big for the top level are tested against every dynamic body
+    for (int k = 0; k < g->oversize_count; k++) {
+        int i = g->oversize[k];
+        for (int m = 0; m < si->dynamic_count; m++) {
+            int j = si->dynamic_bodies[m];
+            if (j == i) continue;
+            int j_oversize = 0;
+            for (int n = 0; n < g->oversize_count; n++) {
+                if (g->oversize[n] == j) { j_oversize = 1; break; }
+            }
+            if (j_oversize && j < i) continue;  // Oversize-oversize pair reported once
+            if (aabb_overlap(&g->aabbs[i], &g->aabbs[j])) {
+                broadphase_add_pair(w, i, j);
+            }
+        }
+    }
+}
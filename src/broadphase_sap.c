@@ -0,0 +1,269 @@
+#include "world.h"  // Pulls in broadphase.h
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Incremental sweep and prune.
+// Endpoints stay sorted across steps, so with small per-step motion the insertion
+// sort below is ~O(n). Every swap of a min and a max endpoint is exactly the moment
+// two boxes start or stop overlapping on that axis, which is when the persistent
+// pair set gets updated. Nothing moves -> no swaps -> nothing to do.
+// Filtered pairs (body_should_collide) never enter the set, so collision filters are
+// expected to be set before the first step.
+
+#define SAP_IS_MAX(id) ((id) & 1)
+#define SAP_BODY(id)   ((id) >> 1)
+
+// --- Persistent pair set (linear probing keyed by body pair) ---
+
+// The table has 2 * pair_capacity slots (a power of two), so it is never more than half full
+static unsigned int table_mask(const SweepAndPrune *s) {
+    return (unsigned int)(2 * s->pair_capacity - 1);
+}
+
+static unsigned int pair_hash(const SweepAndPrune *s, int a, int b) {
+    uint32_t h = (uint32_t)a * 0x9e3779b1u ^ (uint32_t)b * 0x85ebca6bu;
+    return (h ^ (h >> 15)) & table_mask(s);
+}
+
+// Returns the table slot holding (a, b), or the empty slot where it would go
+static int pair_find_slot(const SweepAndPrune *s, int a, int b) {
+    unsigned int slot = pair_hash(s, a, b);
+    while (s->table[slot] != -1) {
+        const BodyPair *p = &s->pairs[s->table[slot]];
+        if (p->a == a && p->b == b) break;
+        slot = (slot + 1) & table_mask(s);
+    }
+    return (int)slot;
+}
+
+// Re-key every tracked pair (after growing the table or renumbering bodies)
+static void rehash(SweepAndPrune *s) {
+    memset(s->table, 0xff, (size_t)(2 * s->pair_capacity) * sizeof(int));  // All slots empty (-1)
+    for (int p = 0; p < s->pair_count; p++) {
+        s->table[pair_find_slot(s, s->pairs[p].a, s->pairs[p].b)] = p;
+    }
+}
+
+// Double the pair set. Returns -1 if out of memory (the set is left as it was).
+static int grow_pairs(SweepAndPrune *s) {
+    int capacity = (s->pair_capacity > 0) ? 2 * s->pair_capacity : BROADPHASE_PAIRS_INITIAL;
+    BodyPair *pairs = (BodyPair *)realloc(s->pairs, (size_t)capacity * sizeof(BodyPair));
+    if (!pairs) return -1;
+    s->pairs = pairs;
+    int *table = (int *)malloc((size_t)(2 * capacity) * sizeof(int));
+    if (!table) return -1;
+    free(s->table);
+    s->table = table;
+    s->pair_capacity = capacity;
+    rehash(s);
+    return 0;
+}
+
+static void pair_add(SweepAndPrune *s, int i, int j) {
+    int a = (i < j) ? i : j;
+    int b = (i < j) ? j : i;
+    if (s->pair_count >= s->pair_capacity) {
+        if (grow_pairs(s) != 0) return;  // Out of memory: drop the pair
+    }
+    int slot = pair_find_slot(s, a, b);
+    if (s->table[slot] != -1) return;  // Already tracked
+
+    s->pairs[s->pair_count].a = a;
+    s->pairs[s->pair_count].b = b;
+    s->table[slot] = s->pair_count++;
+    s->dirty = 1;
+}
+
+static void pair_remove(SweepAndPrune *s, int i, int j) {
+    if (s->pair_count == 0) return;  // Nothing tracked (the table may not exist yet)
+    int a = (i < j) ? i : j;
+    int b = (i < j) ? j : i;
+    int slot = pair_find_slot(s, a, b);
+    int index = s->table[slot];
+    if (index == -1) return;  // Never overlapped on the other axis
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    const unsigned int mask = table_mask(s);
+    unsigned int hole = (unsigned int)slot;
+    unsigned int next = (hole + 1) & mask;
+    while (s->table[next] != -1) {
+        const BodyPair *p = &s->pairs[s->table[next]];
+        unsigned int home = pair_hash(s, p->a, p->b);
+        // Move the entry back if its home slot is not in (hole, next]
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            s->table[hole] = s->table[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    s->table[hole] = -1;
+
+    // Swap-remove from the dense array and repoint the moved pair's slot
+    int last = --s->pair_count;
+    if (index != last) {
+        s->pairs[index] = s->pairs[last];
+        s->table[pair_find_slot(s, s->pairs[index].a, s->pairs[index].b)] = index;
+    }
+    s->dirty = 1;
+}
+
+// --- Endpoint sorting ---
+
+static float endpoint_value(const AABB *box, int axis, int is_max) {
+    const Vec2 *v = is_max ? &box->max : &box->min;
+    return (axis == 0) ? v->x : v->y;
+}
+
+// Order by value; on ties min endpoints come first so touching boxes count as overlapping
+// (matches aabb_overlap).
+static int endpoint_less(const SapEndpoint *e, const SapEndpoint *f) {
+    if (e->value != f->value) return e->value < f->value;
+    return !SAP_IS_MAX(e->id) && SAP_IS_MAX(f->id);
+}
+
+static int compare_endpoints(const void *lhs, const void *rhs) {
+    const SapEndpoint *e = (const SapEndpoint *)lhs;
+    const SapEndpoint *f = (const SapEndpoint *)rhs;
+    if (endpoint_less(e, f)) return -1;
+    if (endpoint_less(f, e)) return 1;
+    return e->id - f->id;
+}
+
+static void sort_axis(World *w, SweepAndPrune *s, int axis) {
+    SapEndpoint *ep = s->endpoints[axis];
+    int n = 2 * s->body_count;
+
+    for (int i = 1; i < n; i++) {
+        SapEndpoint key = ep[i];
+        int j = i - 1;
+        while (j >= 0 && endpoint_less(&key, &ep[j])) {
+            // `key` moves left past ep[j]: the overlap state of the two bodies on this axis flips
+            int body = SAP_BODY(key.id);
+            int other = SAP_BODY(ep[j].id);
+            if (!SAP_IS_MAX(key.id) && SAP_IS_MAX(ep[j].id)) {
+                // Min passed a max: now overlapping on this axis
+                if (aabb_overlap(&s->aabbs[body], &s->aabbs[other]) &&
+                    body_should_collide(&w->bodies[body], &w->bodies[other])) {
+                    pair_add(s, body, other);
+                }
+            } else if (SAP_IS_MAX(key.id) && !SAP_IS_MAX(ep[j].id)) {
+                // Max passed a min: separated on this axis
+                pair_remove(s, body, other);
+            }
+            ep[j + 1] = ep[j];
+            j--;
+        }
+        ep[j + 1] = key;
+    }
+}
+
+// Build endpoints and the pair set from scratch (first step or dynamic body count changed)
+static void rebuild(World *w, SweepAndPrune *s) {
+    const StaticIndex *si = &w->statics;
+    sap_init(s);
+    s->body_count = si->dynamic_count;
+
+    for (int axis = 0; axis < 2; axis++) {
+        for (int k = 0; k < si->dynamic_count; k++) {
+            int i = si->dynamic_bodies[k];
+            for (int is_max = 0; is_max < 2; is_max++) {
+                SapEndpoint *e = &s->endpoints[axis][2 * k + is_max];
+                e->id = (i << 1) | is_max;
+                e->value = endpoint_value(&s->aabbs[i], axis, is_max);
+            }
+        }
+    }
+
+    // Full sort without pair tracking, then sweep x: each min endpoint meets exactly
+    // the boxes still open on x
+    int n = 2 * s->body_count;
+    qsort(s->endpoints[0], (size_t)n, sizeof(SapEndpoint), compare_endpoints);
+    qsort(s->endpoints[1], (size_t)n, sizeof(SapEndpoint), compare_endpoints);
+    SapEndpoint *ep = s->endpoints[0];
+
+    int *active = s->active;
+    int active_count = 0;
+    for (int i = 0; i < n; i++) {
+        int body = SAP_BODY(ep[i].id);
+        if (SAP_IS_MAX(ep[i].id)) {
+            for (int k = 0; k < active_count; k++) {
+                if (active[k] == body) {
+                    active[k] = active[--active_count];
+                    break;
+                }
+            }
+        } else {
+            for (int k = 0; k < active_count; k++) {
+                if (aabb_overlap(&s->aabbs[body], &s->aabbs[active[k]]) &&
+                    body_should_collide(&w->bodies[body], &w->bodies[active[k]])) {
+                    pair_add(s, body, active[k]);
+                }
+            }
+            active[active_count++] = body;
+        }
+    }
+}
+
+// --- Public API ---
+
+void sap_init(SweepAndPrune *sap) {
+    sap->pair_count = 0;
+    if (sap->table) memset(sap->table, 0xff, (size_t)(2 * sap->pair_capacity) * sizeof(int));  // All slots empty (-1)
+    sap->body_count = 0;
+    sap->dirty = 1;
+}
+
+void sap_remap(SweepAndPrune *sap, const int *to) {
+    // Values and endpoint order stay as they are; only the body ids change
+    for (int axis = 0; axis < 2; axis++) {
+        SapEndpoint *ep = sap->endpoints[axis];
+        for (int k = 0; k < 2 * sap->body_count; k++) {
+            ep[k].id = (to[SAP_BODY(ep[k].id)] << 1) | SAP_IS_MAX(ep[k].id);
+        }
+    }
+
+    // Re-key the pair set
+    for (int p = 0; p < sap->pair_count; p++) {
+        int a = to[sap->pairs[p].a];
+        int b = to[sap->pairs[p].b];
+        sap->pairs[p].a = (a < b) ? a : b;
+        sap->pairs[p].b = (a < b) ? b : a;
+    }
+    if (sap->table) rehash(sap);
+    sap->dirty = 1;
+}
+
+void sap_destroy(SweepAndPrune *sap) {
+    free(sap->endpoints[0]);
+    free(sap->endpoints[1]);
+    free(sap->aabbs);
+    free(sap->pairs);
+    free(sap->table);
+    free(sap->active);
+    memset(sap, 0, sizeof(*sap));
+}
+
+void sap_update(World *w) {
+    SweepAndPrune *s = &w->sap;
+
+    const StaticIndex *si = &w->statics;
+    for (int k = 0; k < si->dynamic_count; k++) {
+        int i = si->dynamic_bodies[k];
+        s->aabbs[i] = broadphase_padded_aabb(w, i);
+    }
+
+    if (s->body_count != si->dynamic_count) {
+        rebuild(w, s);
+    } else {
+        for (int axis = 0; axis < 2; axis++) {
+            SapEndpoint *ep = s->endpoints[axis];
+            for (int k = 0; k < 2 * s->body_count; k++) {
+                ep[k].value = endpoint_value(&s->aabbs[SAP_BODY(ep[k].id)], axis, SAP_IS_MAX(ep[k].id));
+            }
+            sort_axis(w, s, axis);
+        }
+    }
+
+    // s->dirty tells broadphase_update whether w->pairs must be republished
+}
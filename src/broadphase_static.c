@@ -0,0 +1,94 @@
+#include "world.h"  // Pulls in broadphase.h
+
+// Static bodies (walls, floors, fixed obstacles) never move and never respond to
+// each other, so they are kept out of the per-step broadphase. They sit in their own
+// AABB tree built once at load, and each dynamic body caches the statics near it.
+// The cache is only re-queried when the body leaves the (grown) box it was built for.
+// Nothing here notices a static body moving: see world_invalidate_statics.
+
+static AABB grow(const AABB *box, float margin) {
+    AABB out = *box;
+    out.min = vec2_sub(out.min, vec2(margin, margin));
+    out.max = vec2_add(out.max, vec2(margin, margin));
+    return out;
+}
+
+static int contains(const AABB *outer, const AABB *inner) {
+    return outer->min.x <= inner->min.x && outer->min.y <= inner->min.y &&
+           outer->max.x >= inner->max.x && outer->max.y >= inner->max.y;
+}
+
+void broadphase_build_statics(World *w) {
+    StaticIndex *si = &w->statics;
+    aabb_tree_init(&si->tree);
+    si->dynamic_count = 0;
+    si->static_count = 0;
+
+    for (int i = 0; i < w->body_count; i++) {
+        const Body *b = &w->bodies[i];
+        if (body_is_static(b)) {
+            AABB box = broadphase_padded_aabb(w, i);
+            si->tree.aabbs[i] = box;
+            aabb_tree_insert(&si->tree, i, &box);
+            si->static_count++;
+        } else {
+            si->dynamic_bodies[si->dynamic_count++] = i;
+            si->cache_count[i] = -1;  // Query on first use
+        }
+    }
+
+    si->built_body_count = w->body_count;
+    si->dirty = 1;
+}
+
+int static_pairs_update(World *w) {
+    StaticIndex *si = &w->statics;
+    if (si->static_count == 0) return 0;
+
+    int changed = 0;
+    for (int k = 0; k < si->dynamic_count; k++) {
+        int i = si->dynamic_bodies[k];
+        AABB box = broadphase_padded_aabb(w, i);
+        if (si->cache_count[i] >= 0 && contains(&si->cache_box[i], &box)) continue;
+
+        // Left its cache box (or never cached): query the static tree with a grown box
+        si->cache_box[i] = grow(&box, STATIC_CACHE_MARGIN);
+        int found = aabb_tree_query(&si->tree, &si->cache_box[i], si->cache[i], STATIC_CACHE_SLOTS);
+        // Too many statics to cache: keep what fits but stay stale so the next step re-queries
+        si->cache_count[i] = (found <= STATIC_CACHE_SLOTS) ? found : -1;
+        changed = 1;
+    }
+
+    si->dirty |= changed;
+    return changed;
+}
+
+void static_pairs_invalidate(World *w) {
+    StaticIndex *si = &w->statics;
+    for (int k = 0; k < si->dynamic_count; k++) {
+        si->cache_count[si->dynamic_bodies[k]] = -1;
+    }
+    si->dirty = 1;
+}
+
+void static_pairs_emit(World *w) {
+    StaticIndex *si = &w->statics;
+    if (si->static_count == 0) return;
+
+    for (int k = 0; k < si->dynamic_count; k++) {
+        int i = si->dynamic_bodies[k];
+        int count = si->cache_count[i];
+        if (count < 0) {
+            // Uncacheable body: emit everything the fresh query found
+            count = aabb_tree_query(&si->tree, &si->cache_box[i], si->query, w->body_capacity);
+            for (int n = 0; n < count && n < w->body_capacity; n++) {
+                broadphase_add_pair(w, i, si->query[n]);
+            }
+            continue;
+        }
+        for (int n = 0; n < count; n++) {
+            broadphase_add_pair(w, i, si->cache[i][n]);
+        }
+    }
+    si->dirty = 0;
+}
@@ -0,0 +1,391 @@
+#include "world.h"  // Pulls in broadphase.h
+
+// Dynamic AABB tree (bounding volume hierarchy).
+// Each body owns a leaf with a fattened box; a body is only removed and reinserted
+// when its tight box escapes the fat one. Insertion picks the sibling with the lowest
+// perimeter cost and AVL-style rotations keep the tree balanced, so a 2000 px wall
+// and a 10 px ball cost the same to query - unlike a uniform grid.
+
+// --- AABB helpers ---
+
+static AABB aabb_union(const AABB *a, const AABB *b) {
+    AABB out;
+    out.min = vec2(fminf(a->min.x, b->min.x), fminf(a->min.y, b->min.y));
+    out.max = vec2(fmaxf(a->max.x, b->max.x), fmaxf(a->max.y, b->max.y));
+    return out;
+}
+
+// 2D analogue of surface area for the insertion cost
+static float aabb_perimeter(const AABB *a) {
+    return 2.0f * ((a->max.x - a->min.x) + (a->max.y - a->min.y));
+}
+
+static int aabb_contains(const AABB *outer, const AABB *inner) {
+    return outer->min.x <= inner->min.x && outer->min.y <= inner->min.y &&
+           outer->max.x >= inner->max.x && outer->max.y >= inner->max.y;
+}
+
+// --- Node pool ---
+
+static int alloc_node(AabbTree *t) {
+    int index = t->free_list;
+    if (index == AABB_TREE_NULL) return AABB_TREE_NULL;  // Cannot happen: 2n nodes hold n leaves
+    AabbTreeNode *n = &t->nodes[index];
+    t->free_list = n->parent;
+    n->parent = AABB_TREE_NULL;
+    n->child1 = AABB_TREE_NULL;
+    n->child2 = AABB_TREE_NULL;
+    n->height = 0;
+    n->body = -1;
+    return index;
+}
+
+static void free_node(AabbTree *t, int index) {
+    t->nodes[index].parent = t->free_list;
+    t->nodes[index].height = -1;
+    t->free_list = index;
+}
+
+static int is_leaf(const AabbTreeNode *n) {
+    return n->child1 == AABB_TREE_NULL;
+}
+
+// --- Balancing ---
+
+static void replace_child(AabbTree *t, int parent, int old_child, int new_child) {
+    if (parent == AABB_TREE_NULL) {
+        t->root = new_child;
+    } else if (t->nodes[parent].child1 == old_child) {
+        t->nodes[parent].child1 = new_child;
+    } else {
+        t->nodes[parent].child2 = new_child;
+    }
+}
+
+// Rotate the taller grandchild up if node `ia` is out of balance.
+// Returns the index of the node that now sits where `ia` was.
+static int balance(AabbTree *t, int ia) {
+    AabbTreeNode *a = &t->nodes[ia];
+    if (is_leaf(a) || a->height < 2) return ia;
+
+    int ib = a->child1;
+    int ic = a->child2;
+    AabbTreeNode *b = &t->nodes[ib];
+    AabbTreeNode *c = &t->nodes[ic];
+    int diff = c->height - b->height;
+
+    if (diff > 1) {
+        // Rotate C up
+        int i_f = c->child1;
+        int i_g = c->child2;
+        AabbTreeNode *f = &t->nodes[i_f];
+        AabbTreeNode *g = &t->nodes[i_g];
+
+        c->child1 = ia;
+        c->parent = a->parent;
+        a->parent = ic;
+        replace_child(t, c->parent, ia, ic);
+
+        if (f->height > g->height) {
+            c->child2 = i_f;
+            a->child2 = i_g;
+            g->parent = ia;
+            a->box = aabb_union(&b->box, &g->box);
+            c->box = aabb_union(&a->box, &f->box);
+            a->height = 1 + (b->height > g->height ? b->height : g->height);
+            c->height = 1 + (a->height > f->height ? a->height : f->height);
+        } else {
+            c->child2 = i_g;
+            a->child2 = i_f;
+            f->parent = ia;
+            a->box = aabb_union(&b->box, &f->box);
+            c->box = aabb_union(&a->box, &g->box);
+            a->height = 1 + (b->height > f->height ? b->height : f->height);
+            c->height = 1 + (a->height > g->height ? a->height : g->height);
+        }
+        return ic;
+    }
+
+    if (diff < -1) {
+        // Rotate B up
+        int id = b->child1;
+        int ie = b->child2;
+        AabbTreeNode *d = &t->nodes[id];
+        AabbTreeNode *e = &t->nodes[ie];
+
+        b->child1 = ia;
+        b->parent = a->parent;
+        a->parent = ib;
+        replace_child(t, b->parent, ia, ib);
+
+        if (d->height > e->height) {
+            b->child2 = id;
+            a->child1 = ie;
+            e->parent = ia;
+            a->box = aabb_union(&c->box, &e->box);
+            b->box = aabb_union(&a->box, &d->box);
+            a->height = 1 + (c->height > e->height ? c->height : e->height);
+            b->height = 1 + (a->height > d->height ? a->height : d->height);
+        } else {
+            b->child2 = ie;
+            a->child1 = id;
+            d->parent = ia;
+            a->box = aabb_union(&c->box, &d->box);
+            b->box = aabb_union(&a->box, &e->box);
+            a->height = 1 + (c->height > d->height ? c->height : d->height);
+            b->height = 1 + (a->height > e->height ? a->height : e->height);
+        }
+        return ib;
+    }
+
+    return ia;
+}
+
+// Walk from `index` to the root, rebalancing and refitting boxes and heights
+static void refit_upwards(AabbTree *t, int index) {
+    while (index != AABB_TREE_NULL) {
+        index = balance(t, index);
+        AabbTreeNode *n = &t->nodes[index];
+        const AabbTreeNode *c1 = &t->nodes[n->child1];
+        const AabbTreeNode *c2 = &t->nodes[n->child2];
+        n->height = 1 + (c1->height > c2->height ? c1->height : c2->height);
+        n->box = aabb_union(&c1->box, &c2->box);
+        index = n->parent;
+    }
+}
+
+// --- Insert / remove ---
+
+static void insert_leaf(AabbTree *t, int leaf) {
+    if (t->root == AABB_TREE_NULL) {
+        t->root = leaf;
+        t->nodes[leaf].parent = AABB_TREE_NULL;
+        return;
+    }
+
+    // Descend towards the sibling that grows the total perimeter least
+    AABB leaf_box = t->nodes[leaf].box;
+    int index = t->root;
+    while (!is_leaf(&t->nodes[index])) {
+        const AabbTreeNode *n = &t->nodes[index];
+        float area = aabb_perimeter(&n->box);
+        AABB combined = aabb_union(&n->box, &leaf_box);
+        float combined_area = aabb_perimeter(&combined);
+
+        // Cost of making a new parent for this node and the leaf
+        float cost = 2.0f * combined_area;
+        // Minimum cost of pushing the leaf further down
+        float inheritance = 2.0f * (combined_area - area);
+
+        float child_cost[2];
+        int children[2] = { n->child1, n->child2 };
+        for (int k = 0; k < 2; k++) {
+            const AabbTreeNode *child = &t->nodes[children[k]];
+            AABB box = aabb_union(&leaf_box, &child->box);
+            if (is_leaf(child)) {
+                child_cost[k] = aabb_perimeter(&box) + inheritance;
+            } else {
+                child_cost[k] = aabb_perimeter(&box) - aabb_perimeter(&child->box) + inheritance;
+            }
+        }
+
+        if (cost < child_cost[0] && cost < child_cost[1]) break;
+        index = (child_cost[0] < child_cost[1]) ? children[0] : children[1];
+    }
+
+    int sibling = index;
+    int old_parent = t->nodes[sibling].parent;
+    int new_parent = alloc_node(t);
+    AabbTreeNode *p = &t->nodes[new_parent];
+    p->parent = old_parent;
+    p->box = aabb_union(&leaf_box, &t->nodes[sibling].box);
+    p->height = t->nodes[sibling].height + 1;
+    p->child1 = sibling;
+    p->child2 = leaf;
+    replace_child(t, old_parent, sibling, new_parent);
+    t->nodes[sibling].parent = new_parent;
+    t->nodes[leaf].parent = new_parent;
+
+    refit_upwards(t, new_parent);
+}
+
+static void remove_leaf(AabbTree *t, int leaf) {
+    if (leaf == t->root) {
+        t->root = AABB_TREE_NULL;
+        return;
+    }
+
+    int parent = t->nodes[leaf].parent;
+    int grand_parent = t->nodes[parent].parent;
+    int sibling = (t->nodes[parent].child1 == leaf) ? t->nodes[parent].child2 : t->nodes[parent].child1;
+
+    // The sibling takes the parent's place
+    replace_child(t, grand_parent, parent, sibling);
+    t->nodes[sibling].parent = grand_parent;
+    free_node(t, parent);
+
+    refit_upwards(t, grand_parent);
+}
+
+static AABB fatten(const AABB *box) {
+    AABB fat = *box;
+    fat.min = vec2_sub(fat.min, vec2(AABB_TREE_FAT_MARGIN, AABB_TREE_FAT_MARGIN));
+    fat.max = vec2_add(fat.max, vec2(AABB_TREE_FAT_MARGIN, AABB_TREE_FAT_MARGIN));
+    return fat;
+}
+
+// --- Pair query ---
+
+static void report_leaf_pair(World *w, const AabbTree *t, const AabbTreeNode *a, const AabbTreeNode *b) {
+    if (aabb_overlap(&t->aabbs[a->body], &t->aabbs[b->body])) {
+        broadphase_add_pair(w, a->body, b->body);
+    }
+}
+
+// All overlapping leaf pairs with one leaf under `ia` and the other under `ib`
+static void cross_pairs(World *w, const AabbTree *t, int ia, int ib) {
+    const AabbTreeNode *a = &t->nodes[ia];
+    const AabbTreeNode *b = &t->nodes[ib];
+    if (!aabb_overlap(&a->box, &b->box)) return;
+
+    if (is_leaf(a) && is_leaf(b)) {
+        report_leaf_pair(w, t, a, b);
+    } else if (is_leaf(b) || (!is_leaf(a) && a->height >= b->height)) {
+        // Descend the taller subtree
+        cross_pairs(w, t, a->child1, ib);
+        cross_pairs(w, t, a->child2, ib);
+    } else {
+        cross_pairs(w, t, ia, b->child1);
+        cross_pairs(w, t, ia, b->child2);
+    }
+}
+
+// All overlapping leaf pairs inside the subtree at `index` (tree self-collision).
+// Subtrees whose boxes are disjoint are skipped wholesale, unlike one query per body.
+static void self_pairs(World *w, const AabbTree *t, int index) {
+    const AabbTreeNode *n = &t->nodes[index];
+    if (is_leaf(n)) return;
+    self_pairs(w, t, n->child1);
+    self_pairs(w, t, n->child2);
+    cross_pairs(w, t, n->child1, n->child2);
+}
+
+// Recursive box query collecting leaf bodies
+static void query_node(const AabbTree *t, int index, const AABB *box, int *out, int max, int *found) {
+    const AabbTreeNode *n = &t->nodes[index];
+    if (!aabb_overlap(&n->box, box)) return;
+
+    if (is_leaf(n)) {
+        if (*found < max) out[*found] = n->body;
+        (*found)++;
+        return;
+    }
+    query_node(t, n->child1, box, out, max, found);
+    query_node(t, n->child2, box, out, max, found);
+}
+
+// --- Public API ---
+
+void aabb_tree_init(AabbTree *tree) {
+    tree->root = AABB_TREE_NULL;
+    tree->proxy_count = 0;
+    tree->reinserts = 0;
+
+    // Thread every node onto the free list
+    for (int i = 0; i < tree->node_capacity; i++) {
+        tree->nodes[i].parent = (i + 1 < tree->node_capacity) ? i + 1 : AABB_TREE_NULL;
+        tree->nodes[i].height = -1;
+    }
+    tree->free_list = (tree->node_capacity > 0) ? 0 : AABB_TREE_NULL;
+}
+
+int aabb_tree_reserve(AabbTree *tree, int body_capacity) {
+    int failed = 0;
+    RESIZE_ARRAY(tree->leaf, body_capacity, failed);
+    RESIZE_ARRAY(tree->aabbs, body_capacity, failed);
+
+    int node_capacity = 2 * body_capacity;
+    if (!failed && node_capacity > tree->node_capacity) {
+        AabbTreeNode *nodes = (AabbTreeNode *)realloc(tree->nodes, (size_t)node_capacity * sizeof(AabbTreeNode));
+        if (!nodes) return -1;
+        tree->nodes = nodes;
+
+        // Existing nodes keep their indices; push the new ones onto the free list
+        for (int i = tree->node_capacity; i < node_capacity; i++) {
+            tree->nodes[i].parent = (i + 1 < node_capacity) ? i + 1 : tree->free_list;
+            tree->nodes[i].height = -1;
+        }
+        tree->free_list = tree->node_capacity;
+        tree->node_capacity = node_capacity;
+    }
+    return failed ? -1 : 0;
+}
+
+void aabb_tree_destroy(AabbTree *tree) {
+    free(tree->nodes);
+    free(tree->leaf);
+    free(tree->aabbs);
+    tree->nodes = NULL;
+    tree->leaf = NULL;
+    tree->aabbs = NULL;
+    tree->node_capacity = 0;
+    aabb_tree_init(tree);
+}
+
+void aabb_tree_insert(AabbTree *tree, int body, const AABB *box) {
+    int leaf = alloc_node(tree);
+    tree->nodes[leaf].body = body;
+    tree->nodes[leaf].box = *box;
+    tree->leaf[body] = leaf;
+    insert_leaf(tree, leaf);
+}
+
+int aabb_tree_query(const AabbTree *tree, const AABB *box, int *out, int max) {
+    int found = 0;
+    if (tree->root != AABB_TREE_NULL) {
+        query_node(tree, tree->root, box, out, max, &found);
+    }
+    return found;
+}
+
+void aabb_tree_remap(AabbTree *tree, const int *to) {
+    // The tree shape does not change: relabel the leaves
+    for (int n = 0; n < tree->node_capacity; n++) {
+        AabbTreeNode *node = &tree->nodes[n];
+        if (node->height != 0) continue;   // Internal or free
+        node->body = to[node->body];
+        tree->leaf[node->body] = n;
+    }
+}
+
+void aabb_tree_update(World *w) {
+    AabbTree *t = &w->aabb_tree;
+    const StaticIndex *si = &w->statics;
+    if (si->dynamic_count < t->proxy_count) {
+        aabb_tree_init(t);  // Bodies were removed (world re-init): start over
+    }
+
+    t->reinserts = 0;
+    for (int k = 0; k < si->dynamic_count; k++) {
+        int i = si->dynamic_bodies[k];
+        t->aabbs[i] = broadphase_padded_aabb(w, i);
+
+        if (k >= t->proxy_count) {
+            // New body: create its leaf
+            AABB fat = fatten(&t->aabbs[i]);
+            aabb_tree_insert(t, i, &fat);
+        } else if (!aabb_contains(&t->nodes[t->leaf[i]].box, &t->aabbs[i])) {
+            // Escaped its fat box: move the leaf
+            int leaf = t->leaf[i];
+            remove_leaf(t, leaf);
+            t->nodes[leaf].box = fatten(&t->aabbs[i]);
+            insert_leaf(t, leaf);
+            t->reinserts++;
+        }
+    }
+    t->proxy_count = si->dynamic_count;
+
+    if (t->root != AABB_TREE_NULL) {
+        self_pairs(w, t, t->root);
+    }
+}
@@ -1,10 +1,17 @@
 #include "collision.h"
 #include "world.h"
 #include <math.h>
+#include <stddef.h>
+
+// x86-64 builds carry AVX2 narrowphase kernels, picked at run time (collision_detect_circles_batch)
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define COLLISION_AVX2 1
+#endif
 
 // --- Positional Correction ---
 // Pushes overlapping bodies apart to prevent sinking
-static void collision_positional_correction(Body *a, Body *b, Collision *col) {
+static void collision_positional_correction(const SolverBody *a, const SolverBody *b, Collision *col) {
     const float PERCENT = 0.2f;   // 20% of penetration corrected per iteration
     const float SLOP = 0.001f;     // small overlap to prevent jitter
     
@@ -14,48 +21,83 @@ static void collision_positional_correction(Body *a, Body *b, Collision *col) {
     float correction = fmaxf(col->penetration - SLOP, 0.0f) * PERCENT / inv_mass_sum;
     Vec2 correction_vec = vec2_scale(col->normal, correction);
     
-    a->position = vec2_sub(a->position, vec2_scale(correction_vec, a->inv_mass));
-    b->position = vec2_add(b->position, vec2_scale(correction_vec, b->inv_mass));
+    if (a->inv_mass != 0.0f) *a->position = vec2_sub(*a->position, vec2_scale(correction_vec, a->inv_mass));
+    if (b->inv_mass != 0.0f) *b->position = vec2_add(*b->position, vec2_scale(correction_vec, b->inv_mass));
 }
 
 
-// --- Impulse-Based Collision Resolution with Angular Effects ---
-void collision_resolve(Body *a, Body *b, Collision *col) {
-    // Early exit if both bodies are static
-    float inv_mass_sum = a->inv_mass + b->inv_mass;
-    if (inv_mass_sum == 0.0f) return;
-    
-    // Vectors from body centers to contact point
-    // These "moment arms" determine how much torque is generated
-    Vec2 r_a = vec2_sub(col->contact, a->position);
-    Vec2 r_b = vec2_sub(col->contact, b->position);
+// Summary fields from the points: deepest penetration, mean contact point
+static void collision_finish_manifold(Collision *col) {
+    col->penetration = col->points[0].penetration;
+    col->contact = col->points[0].point;
+    for (int k = 1; k < col->point_count; k++) {
+        col->penetration = fmaxf(col->penetration, col->points[k].penetration);
+        col->contact = vec2_add(col->contact, col->points[k].point);
+    }
+    if (col->point_count > 1) {
+        col->contact = vec2_scale(col->contact, 1.0f / col->point_count);
+    }
+}
+
+// Apply impulse `j` along the normal at the contact point (pushes B along n, A against it).
+// Static bodies would not change, so they are left alone (see SolverBody).
+static void apply_normal_impulse(const SolverBody *a, const SolverBody *b, const Collision *col, Vec2 r_a, Vec2 r_b, float j) {
+    Vec2 impulse = vec2_scale(col->normal, j);
     
-    // Velocity of contact point on each body
+    // Linear impulse, then angular impulse (torque = r × impulse)
+    // In 2D: torque is a scalar = r_cross_impulse
+    // Angular velocity change: Δω = torque * inv_inertia
+    if (a->inv_mass != 0.0f) {
+        *a->velocity = vec2_sub(*a->velocity, vec2_scale(impulse, a->inv_mass));
+        *a->angular_velocity -= vec2_cross(r_a, impulse) * a->inv_inertia;
+    }
+    if (b->inv_mass != 0.0f) {
+        *b->velocity = vec2_add(*b->velocity, vec2_scale(impulse, b->inv_mass));
+        *b->angular_velocity += vec2_cross(r_b, impulse) * b->inv_inertia;
+    }
+}
+
+// Relative velocity of B with respect to A at the contact point, along the normal
+static float normal_velocity(const SolverBody *a, const SolverBody *b, const Collision *col, Vec2 r_a, Vec2 r_b) {
     // v = v_linear + ω × r
     // In 2D: ω × r = vec2_perp(r) * ω
-    Vec2 vel_a = vec2_add(a->velocity, vec2_scale(vec2_perp(r_a), a->angular_velocity));
-    Vec2 vel_b = vec2_add(b->velocity, vec2_scale(vec2_perp(r_b), b->angular_velocity));
+    Vec2 vel_a = vec2_add(*a->velocity, vec2_scale(vec2_perp(r_a), *a->angular_velocity));
+    Vec2 vel_b = vec2_add(*b->velocity, vec2_scale(vec2_perp(r_b), *b->angular_velocity));
+    return vec2_dot(vec2_sub(vel_b, vel_a), col->normal);
+}
+
+// --- Impulse-Based Collision Resolution with Angular Effects ---
+
+// REST_VEL_EPS: Resting contact threshold (0.05 m/s = 5 pixels/s)
+// Slower approaches come to rest instead of bouncing, preventing jitter in stacks
+#define REST_VEL_EPS (0.05f * PIXELS_PER_METER)  // 5.0 pixels/sec
+
+// Impulse at manifold point k, accumulated in m->normal_impulse[k].
+// Returns the normal velocity change it made at the point (pixels/s).
+static float resolve_point(const SolverBody *a, const SolverBody *b, ContactManifold *m, int k, float inv_mass_sum) {
+    const Collision *col = &m->col;
+    const ContactPoint *p = &col->points[k];
+    if (p->penetration <= -CONTACT_POINT_MARGIN && m->normal_impulse[k] <= 0.0f) return 0.0f;  // Separated here
     
-    // Relative velocity at contact point (b relative to a)
-    Vec2 rel_vel = vec2_sub(vel_b, vel_a);
+    // Vectors from body centers to contact point
+    // These "moment arms" determine how much torque is generated
+    Vec2 r_a = vec2_sub(p->point, *a->position);
+    Vec2 r_b = vec2_sub(p->point, *b->position);
     
     // Relative velocity along collision normal
-    float vel_along_normal = vec2_dot(rel_vel, col->normal);
+    float vel_along_normal = normal_velocity(a, b, col, r_a, r_b);
     
-    // REST_VEL_EPS: Resting contact threshold (0.05 m/s = 5 pixels/s)
-    // Prevents jitter from micro-corrections in stacked objects
-    const float REST_VEL_EPS = 0.05f * PIXELS_PER_METER;  // 5.0 pixels/sec
+    // Separating, and nothing accumulated that could be taken back (a bounce keeps its impulse)
+    if (vel_along_normal >= 0.0f && (m->normal_impulse[k] <= 0.0f || m->impact[k])) return 0.0f;
     
-    // Early exit if bodies are separating or at rest
-    if (vel_along_normal > -REST_VEL_EPS) {
-        // Treat as resting contact - only apply positional correction
-        collision_positional_correction(a, b, col);
-        return;
+    // Impacts bounce with restitution (use minimum of the two bodies); resting contacts
+    // only cancel the approach, or hand back surplus impulse if already separating
+    float e = 0.0f;
+    if (vel_along_normal < -REST_VEL_EPS) {
+        e = fminf(a->restitution, b->restitution);
+        m->impact[k] = 1;
     }
     
-    // Calculate restitution (use minimum of the two bodies)
-    float e = fminf(a->restitution, b->restitution);
-    
     // Cross products of moment arm with normal
     // These measure how much the collision "off-center-ness" contributes to rotation
     float r_a_cross_n = vec2_cross(r_a, col->normal);
@@ -70,31 +112,261 @@ void collision_resolve(Body *a, Body *b, Collision *col) {
     
     // numerical guard against division by zero
     const float EPSILON = 1e-8f;
-    if (inv_mass_sum_angular < EPSILON) {
-        collision_positional_correction(a, b, col);
-        return;
-    }
+    if (inv_mass_sum_angular < EPSILON) return 0.0f;
 
+    // Clamp the accumulated total, not the increment: a later iteration may take back
+    // part of an earlier (or warm-started) impulse, but contacts can only push
     float j = -(1.0f + e) * vel_along_normal / inv_mass_sum_angular;
+    float old_impulse = m->normal_impulse[k];
+    m->normal_impulse[k] = fmaxf(old_impulse + j, 0.0f);
+    j = m->normal_impulse[k] - old_impulse;
+
+    apply_normal_impulse(a, b, col, r_a, r_b, j);
+    return fabsf(j) * inv_mass_sum_angular;
+}
+
+// --- Two-point block solve ---
+// Both points of a two-point manifold at once (2x2 effective mass), so a face landing
+// or resting flat is pushed flat. Solving the points one after the other hands the first
+// point more than its share, which tilts boxes in a stack and bounces them off one corner.
+
+// Effective mass matrix of the two points: k[0] = k11, k[1] = k22, k[2] = k12.
+// Returns 0 if it is ill-conditioned (the points are nearly redundant).
+static int block_mass(const SolverBody *a, const SolverBody *b, Vec2 normal, const Vec2 r_a[2], const Vec2 r_b[2],
+                      float k[3]) {
+    float inv_mass_sum = a->inv_mass + b->inv_mass;
+    float ra_cn0 = vec2_cross(r_a[0], normal), ra_cn1 = vec2_cross(r_a[1], normal);
+    float rb_cn0 = vec2_cross(r_b[0], normal), rb_cn1 = vec2_cross(r_b[1], normal);
+    k[0] = inv_mass_sum + ra_cn0 * ra_cn0 * a->inv_inertia + rb_cn0 * rb_cn0 * b->inv_inertia;
+    k[1] = inv_mass_sum + ra_cn1 * ra_cn1 * a->inv_inertia + rb_cn1 * rb_cn1 * b->inv_inertia;
+    k[2] = inv_mass_sum + ra_cn0 * ra_cn1 * a->inv_inertia + rb_cn0 * rb_cn1 * b->inv_inertia;
+    return k[0] * k[0] < 1000.0f * (k[0] * k[1] - k[2] * k[2]);
+}
+
+// Finds impulses x >= 0 with each point reaching its target normal velocity or x = 0 there
+// (the four cases of the 2D complementarity problem). x is the part of the accumulated
+// impulse above `base` (the part that may not be taken back). Applies the change, stores
+// the larger normal velocity change it made in *velocity_change and returns 1, or returns 0
+// without touching anything if no case fits (rounding).
+static int solve_block(const SolverBody *a, const SolverBody *b, ContactManifold *m, const Vec2 r_a[2], const Vec2 r_b[2],
+                       const float vn[2], const float target[2], const float base[2], const float k[3],
+                       float *velocity_change) {
+    float k11 = k[0], k22 = k[1], k12 = k[2];
+    float det = k11 * k22 - k12 * k12;
     
-    // Apply linear impulse to velocities (same as before)
-    Vec2 impulse = vec2_scale(col->normal, j);
-    a->velocity = vec2_sub(a->velocity, vec2_scale(impulse, a->inv_mass));
-    b->velocity = vec2_add(b->velocity, vec2_scale(impulse, b->inv_mass));
+    // Velocity relative to the target with only the base impulses: vn' = K x + rhs
+    float old0 = m->normal_impulse[0];
+    float old1 = m->normal_impulse[1];
+    float rhs0 = vn[0] - target[0] - (k11 * (old0 - base[0]) + k12 * (old1 - base[1]));
+    float rhs1 = vn[1] - target[1] - (k12 * (old0 - base[0]) + k22 * (old1 - base[1]));
     
-    // Apply angular impulse (torque = r × impulse)
-    // In 2D: torque is a scalar = r_cross_impulse
-    // Angular velocity change: Δω = torque * inv_inertia
-    a->angular_velocity -= vec2_cross(r_a, impulse) * a->inv_inertia;
-    b->angular_velocity += vec2_cross(r_b, impulse) * b->inv_inertia;
+    float x0, x1;
+    if ((x0 = (k12 * rhs1 - k22 * rhs0) / det) >= 0.0f &&
+        (x1 = (k12 * rhs0 - k11 * rhs1) / det) >= 0.0f) {
+        // Both points push
+    } else if ((x0 = -rhs0 / k11) >= 0.0f && k12 * x0 + rhs1 >= 0.0f) {
+        x1 = 0.0f;  // Only point 0 pushes, point 1 separates
+    } else if ((x1 = -rhs1 / k22) >= 0.0f && k12 * x1 + rhs0 >= 0.0f) {
+        x0 = 0.0f;  // Only point 1 pushes
+    } else if (rhs0 >= 0.0f && rhs1 >= 0.0f) {
+        x0 = x1 = 0.0f;  // Both separate
+    } else {
+        return 0;
+    }
+    
+    m->normal_impulse[0] = base[0] + x0;
+    m->normal_impulse[1] = base[1] + x1;
+    float d0 = m->normal_impulse[0] - old0;
+    float d1 = m->normal_impulse[1] - old1;
+    apply_normal_impulse(a, b, &m->col, r_a[0], r_b[0], d0);
+    apply_normal_impulse(a, b, &m->col, r_a[1], r_b[1], d1);
+    *velocity_change = fmaxf(fabsf(k11 * d0 + k12 * d1), fabsf(k12 * d0 + k22 * d1));
+    return 1;
+}
+
+// Relaxation solver's block step. A point that already bounced this step keeps its
+// bounce impulse (base). Returns 0 to have the caller solve the points one by one.
+static int resolve_block(const SolverBody *a, const SolverBody *b, ContactManifold *m, float *velocity_change) {
+    const Collision *col = &m->col;
+    Vec2 r_a[2], r_b[2];
+    float vn[2], target[2], base[2], k[3];
+    float e = fminf(a->restitution, b->restitution);
+    
+    for (int i = 0; i < 2; i++) {
+        if (col->points[i].penetration <= -CONTACT_POINT_MARGIN && m->normal_impulse[i] <= 0.0f) return 0;
+        r_a[i] = vec2_sub(col->points[i].point, *a->position);
+        r_b[i] = vec2_sub(col->points[i].point, *b->position);
+        vn[i] = normal_velocity(a, b, col, r_a[i], r_b[i]);
+        // Impacts bounce with restitution, everything else only stops approaching
+        target[i] = (vn[i] < -REST_VEL_EPS) ? -e * vn[i] : 0.0f;
+        base[i] = m->impact[i] ? m->normal_impulse[i] : 0.0f;
+    }
+    if (!block_mass(a, b, col->normal, r_a, r_b, k)) return 0;
+    if (!solve_block(a, b, m, r_a, r_b, vn, target, base, k, velocity_change)) return 0;
     
-    // Apply positional correction to prevent sinking
-    collision_positional_correction(a, b, col);
+    for (int i = 0; i < 2; i++) {
+        if (target[i] > 0.0f) m->impact[i] = 1;
+    }
+    return 1;
 }
 
-int collision_detect_circles(const Body *a, const Body *b, Collision *out) {
+float collision_resolve(const SolverBody *a, const SolverBody *b, ContactManifold *m) {
+    // Early exit if both bodies are static
+    float inv_mass_sum = a->inv_mass + b->inv_mass;
+    if (inv_mass_sum == 0.0f) return 0.0f;
+    
+    // Otherwise each point sees the velocity left by the previous one (sequential impulses)
+    float velocity_change = 0.0f;
+    if (m->col.point_count < 2 || !resolve_block(a, b, m, &velocity_change)) {
+        for (int k = 0; k < m->col.point_count; k++) {
+            velocity_change = fmaxf(velocity_change, resolve_point(a, b, m, k, inv_mass_sum));
+        }
+    }
+    
+    // Apply positional correction to prevent sinking (once per pair, from the deepest point)
+    collision_positional_correction(a, b, &m->col);
+    return velocity_change;
+}
+
+// --- Sequential Impulse Solver ---
+// Effective masses and bias are fixed for the step; every iteration then only computes
+// the relative normal velocity, the impulse that reaches the bias, and clamps the total.
+
+void contact_manifold_prepare(ContactManifold *m, const SolverBody *a, const SolverBody *b, float dt) {
+    const Collision *col = &m->col;
+    float inv_mass_sum = a->inv_mass + b->inv_mass;
+    float e = fminf(a->restitution, b->restitution);
+    
+    for (int k = 0; k < col->point_count; k++) {
+        const ContactPoint *p = &col->points[k];
+        Vec2 r_a = vec2_sub(p->point, *a->position);
+        Vec2 r_b = vec2_sub(p->point, *b->position);
+        float r_a_cross_n = vec2_cross(r_a, col->normal);
+        float r_b_cross_n = vec2_cross(r_b, col->normal);
+        float k_normal = inv_mass_sum +
+                         r_a_cross_n * r_a_cross_n * a->inv_inertia +
+                         r_b_cross_n * r_b_cross_n * b->inv_inertia;
+        m->normal_mass[k] = (k_normal > 1e-8f) ? 1.0f / k_normal : 0.0f;
+        
+        // Push out a fraction of the penetration per step (Baumgarte), via velocity only
+        m->velocity_bias[k] = SI_BAUMGARTE / dt * fmaxf(p->penetration - SI_LINEAR_SLOP, 0.0f);
+        
+        // Impacts bounce: target the reflected approach speed instead (not cached for warm start)
+        float vel_along_normal = normal_velocity(a, b, col, r_a, r_b);
+        if (vel_along_normal < -SI_RESTITUTION_THRESHOLD && e > 0.0f) {
+            m->velocity_bias[k] = fmaxf(m->velocity_bias[k], -e * vel_along_normal);
+            m->impact[k] = 1;
+        }
+    }
+    
+    // Two-point manifolds are solved as a block while the points are independent enough
+    m->block_mass[0] = 0.0f;
+    if (col->point_count == 2) {
+        Vec2 r_a[2], r_b[2];
+        for (int k = 0; k < 2; k++) {
+            r_a[k] = vec2_sub(col->points[k].point, *a->position);
+            r_b[k] = vec2_sub(col->points[k].point, *b->position);
+        }
+        if (!block_mass(a, b, col->normal, r_a, r_b, m->block_mass)) m->block_mass[0] = 0.0f;
+    }
+}
+
+float collision_solve_contact(const SolverBody *a, const SolverBody *b, ContactManifold *m) {
+    const Collision *col = &m->col;
+    float velocity_change = 0.0f;
+    
+    if (m->block_mass[0] > 0.0f) {
+        Vec2 r_a[2], r_b[2];
+        float vn[2];
+        const float base[2] = { 0.0f, 0.0f };
+        for (int k = 0; k < 2; k++) {
+            r_a[k] = vec2_sub(col->points[k].point, *a->position);
+            r_b[k] = vec2_sub(col->points[k].point, *b->position);
+            vn[k] = normal_velocity(a, b, col, r_a[k], r_b[k]);
+        }
+        if (solve_block(a, b, m, r_a, r_b, vn, m->velocity_bias, base, m->block_mass, &velocity_change)) {
+            return velocity_change;
+        }
+    }
+    
+    for (int k = 0; k < col->point_count; k++) {
+        const ContactPoint *p = &col->points[k];
+        Vec2 r_a = vec2_sub(p->point, *a->position);
+        Vec2 r_b = vec2_sub(p->point, *b->position);
+        
+        float vel_along_normal = normal_velocity(a, b, col, r_a, r_b);
+        float j = m->normal_mass[k] * (m->velocity_bias[k] - vel_along_normal);
+        
+        float old_impulse = m->normal_impulse[k];
+        m->normal_impulse[k] = fmaxf(old_impulse + j, 0.0f);
+        j = m->normal_impulse[k] - old_impulse;
+        
+        apply_normal_impulse(a, b, col, r_a, r_b, j);
+        if (m->normal_mass[k] > 0.0f) {
+            velocity_change = fmaxf(velocity_change, fabsf(j) / m->normal_mass[k]);
+        }
+    }
+    return velocity_change;
+}
+
+const char *solver_name(SolverType type) {
+    switch (type) {
+        case SOLVER_RELAXATION:         return "relaxation";
+        case SOLVER_SEQUENTIAL_IMPULSE: return "sequential_impulse";
+        default:                        return "unknown";
+    }
+}
+
+void contact_manifold_init(ContactManifold *m, Vec2 pa, Vec2 pb) {
+    m->position_a0 = pa;
+    m->position_b0 = pb;
+    for (int k = 0; k < MAX_CONTACT_POINTS; k++) {
+        m->normal_impulse[k] = 0.0f;   // Unused slots stay 0 so "holds impulse" checks can test all
+        m->impact[k] = 0;
+    }
+    for (int k = 0; k < m->col.point_count; k++) {
+        m->penetration0[k] = m->col.points[k].penetration;
+        m->point0[k] = m->col.points[k].point;
+    }
+}
+
+void collision_apply_impulse(const SolverBody *a, const SolverBody *b, Vec2 contact, Vec2 normal, float j) {
+    Collision col;
+    col.normal = normal;
+    apply_normal_impulse(a, b, &col, vec2_sub(contact, *a->position), vec2_sub(contact, *b->position), j);
+}
+
+void contact_manifold_update(ContactManifold *m, Vec2 pa, Vec2 pb) {
+    Vec2 moved_a = vec2_sub(pa, m->position_a0);
+    Vec2 moved_b = vec2_sub(pb, m->position_b0);
+
+    // B moving along the normal (away from A) reduces the overlap
+    float closing = vec2_dot(vec2_sub(moved_b, moved_a), m->col.normal);
+    // Contact points sit between both surfaces: follow their mean motion
+    Vec2 shift = vec2_scale(vec2_add(moved_a, moved_b), 0.5f);
+
+    Collision *col = &m->col;
+    for (int k = 0; k < col->point_count; k++) {
+        col->points[k].penetration = m->penetration0[k] - closing;
+        col->points[k].point = vec2_add(m->point0[k], shift);
+    }
+    collision_finish_manifold(col);
+}
+
+// Fill a circle-circle result: round shapes touch at a single point and feature
+static void circle_contact(Collision *out, Vec2 normal, float penetration, Vec2 contact) {
+    out->normal = normal;
+    out->penetration = penetration;
+    out->contact = contact;
+    out->point_count = 1;
+    out->points[0].point = contact;
+    out->points[0].penetration = penetration;
+    out->points[0].feature = 0;
+}
+
+int collision_detect_circles(const Body *a, Vec2 pa, const Body *b, Vec2 pb, Collision *out) {
     // Vector from A to B
-    Vec2 ab = vec2_sub(b->position, a->position);
+    Vec2 ab = vec2_sub(pb, pa);
     
     // Distance squared between centers
     float dist_sq = vec2_len_sq(ab);
@@ -109,15 +381,14 @@ int collision_detect_circles(const Body *a, const Body *b, Collision *out) {
     
     // Handle case where circles are at the same position
     if (dist < 1e-8f) {
-        out->normal = vec2(1.0f, 0.0f);  // Arbitrary direction
-        out->penetration = radius_sum;
-        out->contact = a->position;
+        circle_contact(out, vec2(1.0f, 0.0f), radius_sum, pa);  // Arbitrary direction
     } else {
         // Normal points from A to B
-        out->normal = vec2_scale(ab, 1.0f / dist);
-        out->penetration = radius_sum - dist;
+        Vec2 normal = vec2_scale(ab, 1.0f / dist);
+        float penetration = radius_sum - dist;
         // Contact point: on the surface of A, offset toward B
-        out->contact = vec2_add(a->position, vec2_scale(out->normal, a->shape.circle.radius - out->penetration * 0.5f));
+        circle_contact(out, normal, penetration,
+                       vec2_add(pa, vec2_scale(normal, a->shape.circle.radius - penetration * 0.5f)));
     }
     
     // body_a and body_b indices are set by the caller
@@ -127,29 +398,106 @@ int collision_detect_circles(const Body *a, const Body *b, Collision *out) {
     return 1;  // Collision detected
 }
 
-// Circle vs Oriented Bounding Box (OBB) collision detection
-// Strategy: Transform circle into rectangle's local coordinate frame where rect is axis-aligned,
-// perform AABB test, then transform results (normal, contact) back to world space.
-// This handles rotated rectangles by using rect->angle
-int collision_detect_circle_rect(const Body *circle, const Body *rect, Collision *out) {
-    float radius = circle->shape.circle.radius;
-    
-    // Compute rectangle half-extents
-    float half_w = rect->shape.rect.width * 0.5f;
-    float half_h = rect->shape.rect.height * 0.5f;
-    
-    // Transform circle center into rectangle's local space (OBB approach)
-    // 1. Translate to rect's origin
-    Vec2 circle_local = vec2_sub(circle->position, rect->position);
-    
-    // 2. Rotate by -rect->angle to align with rect's local axes
-    float cos_angle = cosf(-rect->angle);
-    float sin_angle = sinf(-rect->angle);
-    float local_x = circle_local.x * cos_angle - circle_local.y * sin_angle;
-    float local_y = circle_local.x * sin_angle + circle_local.y * cos_angle;
-    circle_local = vec2(local_x, local_y);
-    
-    // Now perform AABB collision test in local space
+#ifdef COLLISION_AVX2
+// 8 pairs per pass: centers are gathered from the positions stream and radii straight
+// from the Body array, and every lane runs the same operations in the same order as
+// collision_detect_circles (no FMA), so results match it bit for bit. Returns how many
+// pairs it handled; the caller finishes the remainder.
+__attribute__((target("avx2")))
+static int circles_batch_avx2(const Body *bodies, const Vec2 *positions, const int *body_a,
+                              const int *body_b, int count, Collision *out) {
+    const float *base = (const float *)bodies;
+    const float *centers = (const float *)positions;
+    const __m256i stride = _mm256_set1_epi32((int)(sizeof(Body) / sizeof(float)));
+    const int radius = (int)(offsetof(Body, shape.circle.radius) / sizeof(float));
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    int k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i ia = _mm256_loadu_si256((const __m256i *)(body_a + k));
+        __m256i ib = _mm256_loadu_si256((const __m256i *)(body_b + k));
+        __m256i ca = _mm256_add_epi32(ia, ia);   // Vec2 stream: two floats per body
+        __m256i cb = _mm256_add_epi32(ib, ib);
+        __m256 ax = _mm256_i32gather_ps(centers, ca, 4);
+        __m256 ay = _mm256_i32gather_ps(centers + 1, ca, 4);
+        __m256 ra = _mm256_i32gather_ps(base + radius, _mm256_mullo_epi32(ia, stride), 4);
+        __m256 bx = _mm256_i32gather_ps(centers, cb, 4);
+        __m256 by = _mm256_i32gather_ps(centers + 1, cb, 4);
+        __m256 rb = _mm256_i32gather_ps(base + radius, _mm256_mullo_epi32(ib, stride), 4);
+
+        __m256 abx = _mm256_sub_ps(bx, ax);
+        __m256 aby = _mm256_sub_ps(by, ay);
+        __m256 dist_sq = _mm256_add_ps(_mm256_mul_ps(abx, abx), _mm256_mul_ps(aby, aby));
+        __m256 radius_sum = _mm256_add_ps(ra, rb);
+        // !(dist_sq >= radius_sum^2), like the scalar early-out
+        int hits = _mm256_movemask_ps(_mm256_cmp_ps(dist_sq, _mm256_mul_ps(radius_sum, radius_sum), _CMP_NGE_UQ));
+
+        for (int l = 0; l < 8; l++) {
+            out[k + l].point_count = 0;
+            out[k + l].body_a = body_a[k + l];
+            out[k + l].body_b = body_b[k + l];
+        }
+        if (!hits) continue;
+
+        __m256 dist = _mm256_sqrt_ps(dist_sq);
+        __m256 inv_dist = _mm256_div_ps(one, dist);
+        __m256 nx = _mm256_mul_ps(abx, inv_dist);
+        __m256 ny = _mm256_mul_ps(aby, inv_dist);
+        __m256 penetration = _mm256_sub_ps(radius_sum, dist);
+        __m256 offset = _mm256_sub_ps(ra, _mm256_mul_ps(penetration, half));
+        __m256 cx = _mm256_add_ps(ax, _mm256_mul_ps(nx, offset));
+        __m256 cy = _mm256_add_ps(ay, _mm256_mul_ps(ny, offset));
+
+        float d[8], n_x[8], n_y[8], pen[8], c_x[8], c_y[8];
+        _mm256_storeu_ps(d, dist);
+        _mm256_storeu_ps(n_x, nx);
+        _mm256_storeu_ps(n_y, ny);
+        _mm256_storeu_ps(pen, penetration);
+        _mm256_storeu_ps(c_x, cx);
+        _mm256_storeu_ps(c_y, cy);
+        for (int l = 0; l < 8; l++) {
+            if (!(hits & (1 << l))) continue;
+            Collision *col = &out[k + l];
+            if (d[l] < 1e-8f) {
+                // Coincident centers: rare, let the scalar routine pick the normal
+                int i = body_a[k + l];
+                int j = body_b[k + l];
+                collision_detect_circles(&bodies[i], positions[i], &bodies[j], positions[j], col);
+                col->body_a = body_a[k + l];
+                col->body_b = body_b[k + l];
+                continue;
+            }
+            circle_contact(col, vec2(n_x[l], n_y[l]), pen[l], vec2(c_x[l], c_y[l]));
+        }
+    }
+    return k;
+}
+#endif
+
+void collision_detect_circles_batch(const Body *bodies, const Vec2 *positions, const int *body_a,
+                                    const int *body_b, int count, Collision *out) {
+    int k = 0;
+#ifdef COLLISION_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        k = circles_batch_avx2(bodies, positions, body_a, body_b, count, out);
+    }
+#endif
+    for (; k < count; k++) {
+        int i = body_a[k];
+        int j = body_b[k];
+        if (!collision_detect_circles(&bodies[i], positions[i], &bodies[j], positions[j], &out[k])) {
+            out[k].point_count = 0;
+        }
+        out[k].body_a = body_a[k];
+        out[k].body_b = body_b[k];
+    }
+}
+
+// Circle vs the box [-half_w, half_w] x [-half_h, half_h], everything in the box's frame.
+// Fills out's normal (circle -> box), contact, penetration and feature, still in that frame.
+static int circle_vs_local_box(Vec2 circle_local, float radius, float half_w, float half_h,
+                               Collision *out) {
     // Clamp circle center to rectangle bounds to find closest point
     float closest_x = fmaxf(-half_w, fminf(circle_local.x, half_w));
     float closest_y = fmaxf(-half_h, fminf(circle_local.y, half_h));
@@ -185,6 +533,10 @@ int collision_detect_circle_rect(const Body *circle, const Body *rect, Collision
             penetration = radius - dist;
         }
         contact_local = closest_local;
+        // Voronoi region of the rect the circle center is in (3x3 grid of corners and edges)
+        int region_x = (closest_x <= -half_w) ? 0 : (closest_x >= half_w) ? 2 : 1;
+        int region_y = (closest_y <= -half_h) ? 0 : (closest_y >= half_h) ? 2 : 1;
+        out->points[0].feature = region_y * 3 + region_x;
     } else {
         // Circle center is inside rectangle - find closest edge (in local space)
         float dx_left = circle_local.x - (-half_w);
@@ -192,73 +544,88 @@ int collision_detect_circle_rect(const Body *circle, const Body *rect, Collision
         float dy_top = circle_local.y - (-half_h);
         float dy_bottom = half_h - circle_local.y;
         
-        // Find minimum distance to edge
+        // Find minimum distance to edge (features 9-12: center inside, escaping through that edge)
         float min_dist = dx_left;
         normal_local = vec2(1.0f, 0.0f);   // Escape left, normal points right
         contact_local = vec2(-half_w, circle_local.y);
+        out->points[0].feature = 9;
         
         if (dx_right < min_dist) {
             min_dist = dx_right;
             normal_local = vec2(-1.0f, 0.0f);  // Escape right, normal points left
             contact_local = vec2(half_w, circle_local.y);
+            out->points[0].feature = 10;
         }
         if (dy_top < min_dist) {
             min_dist = dy_top;
             normal_local = vec2(0.0f, 1.0f);   // Escape up, normal points down
             contact_local = vec2(circle_local.x, -half_h);
+            out->points[0].feature = 11;
         }
         if (dy_bottom < min_dist) {
             min_dist = dy_bottom;
             normal_local = vec2(0.0f, -1.0f);  // Escape down, normal points up
             contact_local = vec2(circle_local.x, half_h);
+            out->points[0].feature = 12;
         }
         
         penetration = radius + min_dist;
     }
     
-    // Transform results back to world space
-    // Rotate normal by +rect->angle
-    cos_angle = cosf(rect->angle);
-    sin_angle = sinf(rect->angle);
-    float world_nx = normal_local.x * cos_angle - normal_local.y * sin_angle;
-    float world_ny = normal_local.x * sin_angle + normal_local.y * cos_angle;
-    out->normal = vec2(world_nx, world_ny);
-    
-    // Rotate and translate contact point to world space
-    float world_cx = contact_local.x * cos_angle - contact_local.y * sin_angle;
-    float world_cy = contact_local.x * sin_angle + contact_local.y * cos_angle;
-    out->contact = vec2_add(vec2(world_cx, world_cy), rect->position);
-    
+    out->normal = normal_local;
+    out->contact = contact_local;
     out->penetration = penetration;
-    
-    // body_a and body_b indices are set by the caller
-    out->body_a = -1;
-    out->body_b = -1;
-    
-    return 1;  // Collision detected
+    return 1;
 }
 
-// Helper: Get the 4 corners of a rotated rectangle in world space
-static void get_rect_corners(const Body *rect, Vec2 corners[4]) {
+int collision_detect_circle_rect(const Body *circle, Vec2 circle_position, const Body *rect,
+                                 const BodyTransform *rect_xf, Collision *out) {
+    float radius = circle->shape.circle.radius;
+    
+    // Compute rectangle half-extents
     float half_w = rect->shape.rect.width * 0.5f;
     float half_h = rect->shape.rect.height * 0.5f;
-    float cos_angle = cosf(rect->angle);
-    float sin_angle = sinf(rect->angle);
     
-    // Local corners (top-left, top-right, bottom-right, bottom-left)
-    Vec2 local[4] = {
-        vec2(-half_w, -half_h),
-        vec2( half_w, -half_h),
-        vec2( half_w,  half_h),
-        vec2(-half_w,  half_h)
-    };
+    // Transform circle center into rectangle's local space (OBB approach)
+    // 1. Translate to rect's origin
+    Vec2 circle_local = vec2_sub(circle_position, rect_xf->position);
     
-    // Transform to world space
-    for (int i = 0; i < 4; i++) {
-        float wx = local[i].x * cos_angle - local[i].y * sin_angle;
-        float wy = local[i].x * sin_angle + local[i].y * cos_angle;
-        corners[i] = vec2_add(vec2(wx, wy), rect->position);
+    if (rect_xf->axis_aligned) {
+        // Unrotated rect (walls, floors): the translated center already is the local
+        // position, so test against the AABB directly and skip both rotations
+        if (!circle_vs_local_box(circle_local, radius, half_w, half_h, out)) return 0;
+        out->contact = vec2_add(out->contact, rect_xf->position);
+    } else {
+        // 2. Rotate by minus the rect's angle to align with rect's local axes (transpose of the cached matrix)
+        float cos_angle = rect_xf->cos_angle;
+        float sin_angle = rect_xf->sin_angle;
+        float local_x = circle_local.x * cos_angle + circle_local.y * sin_angle;
+        float local_y = -circle_local.x * sin_angle + circle_local.y * cos_angle;
+        if (!circle_vs_local_box(vec2(local_x, local_y), radius, half_w, half_h, out)) return 0;
+        
+        // Transform results back to world space
+        // Rotate normal by the rect's angle
+        Vec2 normal_local = out->normal;
+        float world_nx = normal_local.x * cos_angle - normal_local.y * sin_angle;
+        float world_ny = normal_local.x * sin_angle + normal_local.y * cos_angle;
+        out->normal = vec2(world_nx, world_ny);
+        
+        // Rotate and translate contact point to world space
+        Vec2 contact_local = out->contact;
+        float world_cx = contact_local.x * cos_angle - contact_local.y * sin_angle;
+        float world_cy = contact_local.x * sin_angle + contact_local.y * cos_angle;
+        out->contact = vec2_add(vec2(world_cx, world_cy), rect_xf->position);
     }
+    
+    out->point_count = 1;
+    out->points[0].point = out->contact;
+    out->points[0].penetration = out->penetration;
+    
+    // body_a and body_b indices are set by the caller
+    out->body_a = -1;
+    out->body_b = -1;
+    
+    return 1;  // Collision detected
 }
 
 // Helper: Project a polygon (defined by corners) onto an axis and return [min, max]
@@ -272,32 +639,43 @@ static void project_corners_onto_axis(const Vec2 corners[4], Vec2 axis, float *m
     }
 }
 
-// Helper: Find ALL vertices farthest in a given direction (support points)
-// For edge-edge contacts, there can be 2 vertices with the same projection.
-// Returns the number of support points found (1 or 2) and fills the output array.
-static int get_support_points(const Vec2 corners[4], Vec2 direction, Vec2 out[2]) {
-    const float TOLERANCE = 1e-4f;  // Consider vertices equal if within this distance
+// Rect edges by outward normal: 0 = +right, 1 = -right, 2 = +up, 3 = -up.
+// Corner indices follow BodyTransform.corners (TL, TR, BR, BL).
+static const int RECT_EDGE_CORNERS[4][2] = { {1, 2}, {3, 0}, {2, 3}, {0, 1} };
+
+static Vec2 rect_edge_normal(const BodyTransform *xf, int edge) {
+    Vec2 right = vec2(xf->cos_angle, xf->sin_angle);
+    Vec2 up = vec2(-xf->sin_angle, xf->cos_angle);
+    switch (edge) {
+        case 0:  return right;
+        case 1:  return vec2_negate(right);
+        case 2:  return up;
+        default: return vec2_negate(up);
+    }
+}
+
+// Incident-edge vertex during clipping; id = corner it came from (feature for warm starting)
+typedef struct {
+    Vec2 p;
+    int id;
+} ClipVertex;
+
+// Keep the part of segment `in` with dot(n, p) <= offset. Returns the vertices kept (0-2).
+static int clip_segment(ClipVertex out[2], const ClipVertex in[2], Vec2 n, float offset) {
+    float d0 = vec2_dot(n, in[0].p) - offset;
+    float d1 = vec2_dot(n, in[1].p) - offset;
+    int count = 0;
     
-    float max_proj = vec2_dot(corners[0], direction);
-    out[0] = corners[0];
-    int count = 1;
+    if (d0 <= 0.0f) out[count++] = in[0];
+    if (d1 <= 0.0f) out[count++] = in[1];
     
-    for (int i = 1; i < 4; i++) {
-        float proj = vec2_dot(corners[i], direction);
-        
-        if (proj > max_proj + TOLERANCE) {
-            // Found a new maximum - reset
-            max_proj = proj;
-            out[0] = corners[i];
-            count = 1;
-        } else if (fabsf(proj - max_proj) <= TOLERANCE) {
-            // This vertex is equally far - it's part of the support edge
-            if (count < 2) {
-                out[count++] = corners[i];
-            }
-        }
+    // Endpoints on opposite sides: add the intersection, tagged with the clipped vertex
+    if (d0 * d1 < 0.0f) {
+        float t = d0 / (d0 - d1);
+        out[count].p = vec2_add(in[0].p, vec2_scale(vec2_sub(in[1].p, in[0].p), t));
+        out[count].id = (d0 > 0.0f) ? in[0].id : in[1].id;
+        count++;
     }
-    
     return count;
 }
 
@@ -316,131 +694,331 @@ static float get_overlap(float min_a, float max_a, float min_b, float max_b) {
     return (overlap1 < overlap2) ? overlap1 : overlap2;
 }
 
-// Rectangle-Rectangle collision using Separating Axis Theorem (SAT)
-// Tests 4 axes: 2 from each rectangle's edges
-// Returns 1 if colliding, fills collision data in `out`
-int collision_detect_rects(const Body *a, const Body *b, Collision *out) {
-    // Get corners in world space
-    Vec2 corners_a[4], corners_b[4];
-    get_rect_corners(a, corners_a);
-    get_rect_corners(b, corners_b);
-    
-    // Get the two axis directions for each rectangle
-    // Axis 0: edge direction (right vector)
-    // Axis 1: perpendicular to edge (up vector)
-    Vec2 axes[4];
-    axes[0] = vec2(cosf(a->angle), sinf(a->angle));      // A's right axis
-    axes[1] = vec2(-sinf(a->angle), cosf(a->angle));     // A's up axis
-    axes[2] = vec2(cosf(b->angle), sinf(b->angle));      // B's right axis
-    axes[3] = vec2(-sinf(b->angle), cosf(b->angle));     // B's up axis
-    
-    // Track minimum overlap axis (for collision resolution)
-    float min_overlap = INFINITY;
-    Vec2 collision_axis = VEC2_ZERO;
-    
-    // Test all 4 axes for separation
-    for (int i = 0; i < 4; i++) {
-        Vec2 axis = axes[i];
-        
-        // Normalize axis (should already be normalized, but ensure it)
-        float len = vec2_len(axis);
-        if (len < 1e-8f) continue;
-        axis = vec2_scale(axis, 1.0f / len);
-        
-        // Project both rectangles onto this axis
-        float min_a, max_a, min_b, max_b;
-        project_corners_onto_axis(corners_a, axis, &min_a, &max_a);
-        project_corners_onto_axis(corners_b, axis, &min_b, &max_b);
-        
-        // Check for separation
-        float overlap = get_overlap(min_a, max_a, min_b, max_b);
-        
-        if (overlap < 0.0f) {
-            // Found separating axis - no collision
+// Rect axes tested by SAT: 0 = A's right, 1 = A's up, 2 = B's right, 3 = B's up.
+// They come straight from the cached rotation, which is unit length to rounding.
+static Vec2 rect_sat_axis(const BodyTransform *xa, const BodyTransform *xb, int index) {
+    const BodyTransform *xf = (index < 2) ? xa : xb;
+    return (index % 2 == 0) ? vec2(xf->cos_angle, xf->sin_angle) : vec2(-xf->sin_angle, xf->cos_angle);
+}
+
+// Corner range along world x (coord 0) or y (coord 1). For an axis-aligned rect that
+// is its own right/up axis, so this is project_corners_onto_axis minus the dot products.
+static void project_corners_onto_coord(const Vec2 corners[4], int coord, float *min, float *max) {
+    *min = *max = coord ? corners[0].y : corners[0].x;
+    
+    for (int i = 1; i < 4; i++) {
+        float projection = coord ? corners[i].y : corners[i].x;
+        if (projection < *min) *min = projection;
+        if (projection > *max) *max = projection;
+    }
+}
+
+// Projections of both rects onto SAT axis `index`. When the axis belongs to an
+// axis-aligned rect, that rect's range is its AABB (equal to its corner range exactly)
+// and the other rect only needs its corner coordinates.
+static void rect_sat_project(const BodyTransform *xa, const BodyTransform *xb, int index,
+                             float *min_a, float *max_a, float *min_b, float *max_b) {
+    const BodyTransform *owner = (index < 2) ? xa : xb;
+    if (!owner->axis_aligned) {
+        Vec2 axis = rect_sat_axis(xa, xb, index);
+        project_corners_onto_axis(xa->corners, axis, min_a, max_a);
+        project_corners_onto_axis(xb->corners, axis, min_b, max_b);
+        return;
+    }
+    
+    int coord = index % 2;
+    const BodyTransform *other = (index < 2) ? xb : xa;
+    float owner_min = coord ? owner->aabb.min.y : owner->aabb.min.x;
+    float owner_max = coord ? owner->aabb.max.y : owner->aabb.max.x;
+    float other_min, other_max;
+    if (other->axis_aligned) {
+        other_min = coord ? other->aabb.min.y : other->aabb.min.x;
+        other_max = coord ? other->aabb.max.y : other->aabb.max.x;
+    } else {
+        project_corners_onto_coord(other->corners, coord, &other_min, &other_max);
+    }
+    
+    if (index < 2) {
+        *min_a = owner_min; *max_a = owner_max;
+        *min_b = other_min; *max_b = other_max;
+    } else {
+        *min_a = other_min; *max_a = other_max;
+        *min_b = owner_min; *max_b = owner_max;
+    }
+}
+
+// Separating axis test over the 4 axes. Returns 0 if some axis separates the rects,
+// with that axis in axis_index, else 1 with the axis of least overlap (the first one
+// on ties) and that overlap. Axis `hint` (-1 = none) is tried first: apart pairs
+// usually stay apart along the same axis, so they cost one projection. The result
+// does not depend on the hint.
+// Two axis-aligned rects share their axes, so that case is a 2-axis AABB test.
+static int rect_sat(const BodyTransform *xa, const BodyTransform *xb, int hint,
+                    int *axis_index, float *min_overlap) {
+    int axis_count = (xa->axis_aligned && xb->axis_aligned) ? 2 : 4;
+    float min_a, max_a, min_b, max_b;
+    float hint_overlap = 0.0f;
+    if (hint >= 0) {
+        rect_sat_project(xa, xb, hint, &min_a, &max_a, &min_b, &max_b);
+        hint_overlap = get_overlap(min_a, max_a, min_b, max_b);
+        if (hint_overlap < 0.0f) {
+            *axis_index = hint;
             return 0;
         }
+    }
+    
+    *min_overlap = INFINITY;
+    *axis_index = 0;
+    for (int i = 0; i < axis_count; i++) {
+        float overlap = hint_overlap;
+        if (i != hint) {
+            // Project both rectangles onto this axis
+            rect_sat_project(xa, xb, i, &min_a, &max_a, &min_b, &max_b);
+            overlap = get_overlap(min_a, max_a, min_b, max_b);
+        }
+        if (overlap < 0.0f) {
+            *axis_index = i;
+            return 0;  // Found separating axis - no collision
+        }
         
         // Track axis with minimum overlap (that's our collision axis)
-        if (overlap < min_overlap) {
-            min_overlap = overlap;
-            collision_axis = axis;
+        if (overlap < *min_overlap) {
+            *min_overlap = overlap;
+            *axis_index = i;
         }
     }
-    
-    // No separating axis found - rectangles are colliding
-    out->penetration = min_overlap;
+    return 1;
+}
+
+// Contact manifold of two overlapping rects, given the SAT result
+static void rect_manifold(const BodyTransform *xa, const BodyTransform *xb,
+                          int collision_axis_index, float min_overlap, Collision *out) {
+    Vec2 collision_axis = rect_sat_axis(xa, xb, collision_axis_index);
     
     // Ensure normal points from A to B
-    Vec2 ab = vec2_sub(b->position, a->position);
+    Vec2 ab = vec2_sub(xb->position, xa->position);
     if (vec2_dot(collision_axis, ab) < 0.0f) {
         collision_axis = vec2_negate(collision_axis);
     }
     out->normal = collision_axis;
     
-    // Calculate contact point using support points with proper clipping:
-    // - Find support vertices on each shape (1 = vertex contact, 2 = edge contact)
-    // - Handle vertex-edge and edge-edge cases properly
-    Vec2 supports_a[2], supports_b[2];
-    int count_a = get_support_points(corners_a, out->normal, supports_a);
-    int count_b = get_support_points(corners_b, vec2_negate(out->normal), supports_b);
-    
-    // Get the tangent (perpendicular to normal) for edge clipping
-    Vec2 tangent = vec2_perp(out->normal);
-    
-    if (count_a == 1 && count_b == 1) {
-        // Vertex-vertex: average both vertices
-        out->contact = vec2_scale(vec2_add(supports_a[0], supports_b[0]), 0.5f);
-    }
-    else if (count_a == 1) {
-        // Vertex of A hitting edge of B: contact is at A's vertex
-        out->contact = supports_a[0];
-    }
-    else if (count_b == 1) {
-        // Vertex of B hitting edge of A: contact is at B's vertex
-        out->contact = supports_b[0];
-    }
-    else {
-        // Edge-edge: clip to find the overlapping segment
-        // Project all 4 points onto the tangent axis
-        float a0_t = vec2_dot(supports_a[0], tangent);
-        float a1_t = vec2_dot(supports_a[1], tangent);
-        float b0_t = vec2_dot(supports_b[0], tangent);
-        float b1_t = vec2_dot(supports_b[1], tangent);
-        
-        // Get ranges on tangent axis
-        float min_a = fminf(a0_t, a1_t);
-        float max_a = fmaxf(a0_t, a1_t);
-        float min_b = fminf(b0_t, b1_t);
-        float max_b = fmaxf(b0_t, b1_t);
-        
-        // Find overlap interval
-        float overlap_min = fmaxf(min_a, min_b);
-        float overlap_max = fminf(max_a, max_b);
-        
-        if (overlap_max >= overlap_min) {
-            // Edges overlap: contact is at the center of the overlap
-            float overlap_center = (overlap_min + overlap_max) * 0.5f;
-            
-            // Project onto the collision axis to get depth position
-            float depth_a = vec2_dot(supports_a[0], out->normal);
-            float depth_b = vec2_dot(supports_b[0], out->normal);
-            float depth_center = (depth_a + depth_b) * 0.5f;
+    // Contact manifold by clipping (reference face = the face of the min-overlap axis):
+    // the incident face (most anti-parallel face of the other rect) is clipped to the
+    // side planes of the reference face, and every clipped vertex that lies behind the
+    // reference face becomes a contact point with its own depth. Points just in front of
+    // it are kept too, so a box resting flat does not rock on whichever corner is lower.
+    int ref_is_b = (collision_axis_index >= 2);
+    const BodyTransform *ref = ref_is_b ? xb : xa;
+    const BodyTransform *inc = ref_is_b ? xa : xb;
+    Vec2 ref_normal = ref_is_b ? vec2_negate(out->normal) : out->normal;  // Points into the incident rect
+    
+    int ref_edge = (collision_axis_index % 2) * 2;
+    if (vec2_dot(ref_normal, rect_edge_normal(ref, ref_edge)) < 0.0f) ref_edge++;
+    
+    int inc_edge = 0;
+    float min_dot = INFINITY;
+    for (int e = 0; e < 4; e++) {
+        float d = vec2_dot(rect_edge_normal(inc, e), ref_normal);
+        if (d < min_dot) {
+            min_dot = d;
+            inc_edge = e;
+        }
+    }
+    
+    ClipVertex incident[2];
+    for (int k = 0; k < 2; k++) {
+        incident[k].id = RECT_EDGE_CORNERS[inc_edge][k];
+        incident[k].p = inc->corners[incident[k].id];
+    }
+    
+    Vec2 ref_v1 = ref->corners[RECT_EDGE_CORNERS[ref_edge][0]];
+    Vec2 ref_v2 = ref->corners[RECT_EDGE_CORNERS[ref_edge][1]];
+    Vec2 tangent = vec2_sub(ref_v2, ref_v1);
+    tangent = vec2_scale(tangent, 1.0f / fmaxf(vec2_len(tangent), 1e-8f));
+    
+    ClipVertex clip1[2], clip2[2];
+    int clipped = clip_segment(clip1, incident, vec2_negate(tangent), -vec2_dot(tangent, ref_v1)) == 2 &&
+                  clip_segment(clip2, clip1, tangent, vec2_dot(tangent, ref_v2)) == 2;
+    
+    float face_offset = vec2_dot(ref_normal, ref_v1);
+    int feature_base = (ref_is_b * 4 + ref_edge) * 4;
+    out->point_count = 0;
+    if (clipped) {
+        for (int k = 0; k < 2; k++) {
+            float separation = vec2_dot(ref_normal, clip2[k].p) - face_offset;
+            if (separation > CONTACT_POINT_MARGIN) continue;  // Clearly in front of the reference face
             
-            // Reconstruct contact point from tangent and normal coordinates
-            out->contact = vec2_add(
-                vec2_scale(tangent, overlap_center),
-                vec2_scale(out->normal, depth_center)
-            );
-        } else {
-            // No overlap (shouldn't happen if collision detected): fallback to average
-            Vec2 center_a = vec2_scale(vec2_add(supports_a[0], supports_a[1]), 0.5f);
-            Vec2 center_b = vec2_scale(vec2_add(supports_b[0], supports_b[1]), 0.5f);
-            out->contact = vec2_scale(vec2_add(center_a, center_b), 0.5f);
+            ContactPoint *p = &out->points[out->point_count++];
+            // Halfway between the incident vertex and the reference face
+            p->point = vec2_sub(clip2[k].p, vec2_scale(ref_normal, separation * 0.5f));
+            p->penetration = -separation;
+            p->feature = feature_base + clip2[k].id;
         }
     }
     
+    if (out->point_count == 0) {
+        // Degenerate clip (rounding at a corner touch): deepest incident vertex, SAT depth
+        int k = (vec2_dot(ref_normal, incident[0].p) <= vec2_dot(ref_normal, incident[1].p)) ? 0 : 1;
+        ContactPoint *p = &out->points[out->point_count++];
+        p->point = vec2_add(incident[k].p, vec2_scale(ref_normal, min_overlap * 0.5f));
+        p->penetration = min_overlap;
+        p->feature = feature_base + incident[k].id;
+    }
+    collision_finish_manifold(out);
+    
     out->body_a = -1;
     out->body_b = -1;
-    
+}
+
+// Rectangle-Rectangle collision using Separating Axis Theorem (SAT)
+// Tests 4 axes: 2 from each rectangle's edges
+// Returns 1 if colliding, fills collision data in `out`
+int collision_detect_rects(const BodyTransform *xa, const BodyTransform *xb, int *sat_axis, Collision *out) {
+    int axis_index;
+    float min_overlap;
+    int hint = (sat_axis && *sat_axis != SAT_AXIS_NONE) ? *sat_axis % SAT_AXIS_TOUCHING : -1;
+    int hit = rect_sat(xa, xb, hint, &axis_index, &min_overlap);
+    if (sat_axis) *sat_axis = hit ? axis_index + SAT_AXIS_TOUCHING : axis_index;
+    if (!hit) return 0;
+    rect_manifold(xa, xb, axis_index, min_overlap, out);
     return 1;  // Collision detected
 }
+
+#ifdef COLLISION_AVX2
+// SAT for 8 rect pairs per pass, one pair per lane: rotations and corners are gathered
+// from the transform array, and each axis is tested on all lanes with the same
+// operations and tie rules as rect_sat (projections use min/max, which pick exactly
+// like its comparisons), so hits, axes and overlaps match it bit for bit. Only the
+// overlapping pairs go on to the scalar clipping. When every lane was apart last step,
+// the lanes' hinted axes are tested first, and a group they all separate skips the
+// other axes (a group with a touching pair would only pay for the extra pass).
+// Returns how many pairs it handled.
+__attribute__((target("avx2")))
+static int rects_batch_avx2(const BodyTransform *transforms,
+                            const int *body_a, const int *body_b, int *sat_axis, int count,
+                            Collision *out) {
+    const float *base = (const float *)transforms;
+    const __m256i stride = _mm256_set1_epi32((int)(sizeof(BodyTransform) / sizeof(float)));
+    const int cos_at = (int)(offsetof(BodyTransform, cos_angle) / sizeof(float));
+    const int sin_at = (int)(offsetof(BodyTransform, sin_angle) / sizeof(float));
+    const int corners_at = (int)(offsetof(BodyTransform, corners) / sizeof(float));
+
+    int k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i ia = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(body_a + k)), stride);
+        __m256i ib = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(body_b + k)), stride);
+
+        // Corners (x, y) of both rects and the 4 axes, lane = pair
+        __m256 ax[4], ay[4], bx[4], by[4];
+        for (int c = 0; c < 4; c++) {
+            ax[c] = _mm256_i32gather_ps(base + corners_at + 2 * c, ia, 4);
+            ay[c] = _mm256_i32gather_ps(base + corners_at + 2 * c + 1, ia, 4);
+            bx[c] = _mm256_i32gather_ps(base + corners_at + 2 * c, ib, 4);
+            by[c] = _mm256_i32gather_ps(base + corners_at + 2 * c + 1, ib, 4);
+        }
+        __m256 cos_a = _mm256_i32gather_ps(base + cos_at, ia, 4);
+        __m256 sin_a = _mm256_i32gather_ps(base + sin_at, ia, 4);
+        __m256 cos_b = _mm256_i32gather_ps(base + cos_at, ib, 4);
+        __m256 sin_b = _mm256_i32gather_ps(base + sin_at, ib, 4);
+        const __m256 zero = _mm256_setzero_ps();
+        __m256 axis_x[4] = { cos_a, _mm256_sub_ps(zero, sin_a), cos_b, _mm256_sub_ps(zero, sin_b) };
+        __m256 axis_y[4] = { sin_a, cos_a, sin_b, cos_b };
+
+        // Hinted axis per lane; the hint pass only runs if all 8 are separating axes
+        __m256i hint_index = _mm256_loadu_si256((const __m256i *)(sat_axis + k));
+        __m256i hint_valid = _mm256_and_si256(
+            _mm256_cmpgt_epi32(hint_index, _mm256_set1_epi32(SAT_AXIS_NONE)),
+            _mm256_cmpgt_epi32(_mm256_set1_epi32(SAT_AXIS_TOUCHING), hint_index));
+        int first_pass = (_mm256_movemask_ps(_mm256_castsi256_ps(hint_valid)) == 0xFF) ? -1 : 0;
+        __m256 hint = _mm256_cvtepi32_ps(hint_index);
+        __m256 hint_x = axis_x[0];
+        __m256 hint_y = axis_y[0];
+        for (int i = 1; i < 4; i++) {
+            __m256 is_hint = _mm256_cmp_ps(hint, _mm256_set1_ps((float)i), _CMP_EQ_OQ);
+            hint_x = _mm256_blendv_ps(hint_x, axis_x[i], is_hint);
+            hint_y = _mm256_blendv_ps(hint_y, axis_y[i], is_hint);
+        }
+
+        // Pass -1 tests the hinted axes, passes 0-3 the SAT axes in rect_sat order
+        __m256 separated = _mm256_setzero_ps();
+        __m256 separating_axis = hint;
+        __m256 min_overlap = _mm256_set1_ps(INFINITY);
+        __m256 axis_index = _mm256_setzero_ps();
+        for (int i = first_pass; i < 4; i++) {
+            __m256 dir_x = (i < 0) ? hint_x : axis_x[i];
+            __m256 dir_y = (i < 0) ? hint_y : axis_y[i];
+            __m256 min_a = _mm256_add_ps(_mm256_mul_ps(ax[0], dir_x), _mm256_mul_ps(ay[0], dir_y));
+            __m256 min_b = _mm256_add_ps(_mm256_mul_ps(bx[0], dir_x), _mm256_mul_ps(by[0], dir_y));
+            __m256 max_a = min_a;
+            __m256 max_b = min_b;
+            for (int c = 1; c < 4; c++) {
+                __m256 pa = _mm256_add_ps(_mm256_mul_ps(ax[c], dir_x), _mm256_mul_ps(ay[c], dir_y));
+                __m256 pb = _mm256_add_ps(_mm256_mul_ps(bx[c], dir_x), _mm256_mul_ps(by[c], dir_y));
+                min_a = _mm256_min_ps(pa, min_a);   // (pa < min_a) ? pa : min_a
+                max_a = _mm256_max_ps(pa, max_a);   // (pa > max_a) ? pa : max_a
+                min_b = _mm256_min_ps(pb, min_b);
+                max_b = _mm256_max_ps(pb, max_b);
+            }
+
+            __m256 apart = _mm256_or_ps(_mm256_cmp_ps(max_a, min_b, _CMP_LT_OQ),
+                                        _mm256_cmp_ps(max_b, min_a, _CMP_LT_OQ));
+            if (i >= 0) {
+                // Lanes first separated here report this axis
+                __m256 first = _mm256_andnot_ps(separated, apart);
+                separating_axis = _mm256_blendv_ps(separating_axis, _mm256_set1_ps((float)i), first);
+            }
+            separated = _mm256_or_ps(separated, apart);
+            if (_mm256_movemask_ps(separated) == 0xFF) break;  // Every lane already separated
+            if (i < 0) continue;
+
+            __m256 overlap1 = _mm256_sub_ps(max_a, min_b);
+            __m256 overlap2 = _mm256_sub_ps(max_b, min_a);
+            __m256 overlap = _mm256_min_ps(overlap1, overlap2);   // (o1 < o2) ? o1 : o2
+            __m256 better = _mm256_cmp_ps(overlap, min_overlap, _CMP_LT_OQ);
+            min_overlap = _mm256_blendv_ps(min_overlap, overlap, better);
+            axis_index = _mm256_blendv_ps(axis_index, _mm256_set1_ps((float)i), better);
+        }
+
+        int hits = ~_mm256_movemask_ps(separated) & 0xFF;
+        float overlaps[8], axes[8], separating[8];
+        _mm256_storeu_ps(overlaps, min_overlap);
+        _mm256_storeu_ps(axes, axis_index);
+        _mm256_storeu_ps(separating, separating_axis);
+        for (int l = 0; l < 8; l++) {
+            Collision *col = &out[k + l];
+            int i = body_a[k + l];
+            int j = body_b[k + l];
+            col->point_count = 0;
+            if (hits & (1 << l)) {
+                rect_manifold(&transforms[i], &transforms[j],
+                              (int)axes[l], overlaps[l], col);
+                sat_axis[k + l] = (int)axes[l] + SAT_AXIS_TOUCHING;
+            } else {
+                sat_axis[k + l] = (int)separating[l];
+            }
+            col->body_a = i;
+            col->body_b = j;
+        }
+    }
+    return k;
+}
+#endif
+
+void collision_detect_rects_batch(const BodyTransform *transforms, const int *body_a, const int *body_b,
+                                  int *sat_axis, int count, Collision *out) {
+    int k = 0;
+#ifdef COLLISION_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        k = rects_batch_avx2(transforms, body_a, body_b, sat_axis, count, out);
+    }
+#endif
+    for (; k < count; k++) {
+        int i = body_a[k];
+        int j = body_b[k];
+        if (!collision_detect_rects(&transforms[i], &transforms[j], &sat_axis[k], &out[k])) {
+            out[k].point_count = 0;
+        }
+        out[k].body_a = i;
+        out[k].body_b = j;
+    }
+}
@@ -3,25 +3,142 @@
 
 #include "body.h"
 
+// Contact solver used by world_step (selected per world, see world_set_solver)
+typedef enum {
+    SOLVER_RELAXATION,          // Restitution impulse + 20% positional correction per iteration (collision_resolve)
+    SOLVER_SEQUENTIAL_IMPULSE,  // Velocity-only, accumulated clamped impulses with a Baumgarte bias (collision_solve_contact)
+    SOLVER_COUNT
+} SolverType;
+
+#define MAX_CONTACT_POINTS 2   // Rect-rect face contacts clip to two points
+#define CONTACT_POINT_MARGIN 0.25f   // Clipped points this close in front of the reference face still count (pixels)
+
+// One point of a contact manifold
+typedef struct {
+    Vec2 point;           // World-space contact point (midway between the two surfaces)
+    float penetration;    // Overlap depth along the normal at this point (> -CONTACT_POINT_MARGIN)
+    int feature;          // Which edge/vertex combination touches; stable while the point persists
+} ContactPoint;
+
 typedef struct {
     int body_a;           // Index of first body
     int body_b;           // Index of second body
     Vec2 normal;          // Collision normal (points from A to B)
-    float penetration;    // Overlap depth
-    Vec2 contact;         // Contact point (midpoint on collision axis)
+    float penetration;    // Overlap depth (deepest point)
+    Vec2 contact;         // Contact point (mean of the manifold points)
+    ContactPoint points[MAX_CONTACT_POINTS];
+    int point_count;      // 1 for anything involving a circle, 1-2 for rect-rect
 } Collision;
 
+// Contact kept for a whole step: the narrowphase runs once, then each solver
+// iteration only shifts the penetration by how far the two bodies moved since.
+// Valid while angles are fixed (the solver only corrects positions).
+typedef struct {
+    Collision col;        // Current normal, contact points and penetrations
+    Vec2 position_a0;     // Body positions at detection
+    Vec2 position_b0;
+    float penetration0[MAX_CONTACT_POINTS];     // Per-point penetration at detection
+    Vec2 point0[MAX_CONTACT_POINTS];            // Per-point position at detection
+    float normal_impulse[MAX_CONTACT_POINTS];   // Accumulated per-point impulse this step, >= 0 (warm-started)
+    int impact[MAX_CONTACT_POINTS];             // Restitution was applied this step (a bounce, not resting)
+
+    // Sequential impulse only, set by contact_manifold_prepare
+    float normal_mass[MAX_CONTACT_POINTS];      // 1 / effective mass along the normal at the point
+    float velocity_bias[MAX_CONTACT_POINTS];    // Target separating velocity (penetration recovery + bounce)
+    float block_mass[3];                        // Two-point effective mass (k11, k22, k12); k11 = 0 = solve points one by one
+} ContactManifold;
+
+// A body as the contact solver sees it: its mass properties, copied from the Body, and
+// its hot state by pointer into the world's per-body streams. Static bodies are only
+// read (nothing is stored to them), so threads sharing one do not race.
+typedef struct {
+    Vec2 *position;
+    Vec2 *velocity;
+    float *angular_velocity;
+    float inv_mass;
+    float inv_inertia;
+    float restitution;
+} SolverBody;
+
+// Fraction of last step's impulse re-applied to a persisting contact
+#define CONTACT_WARM_START 1.0f
+
+// Sequential impulse tuning
+#define SI_BAUMGARTE 0.2f       // Fraction of penetration (beyond the slop) turned into separating velocity per step
+#define SI_LINEAR_SLOP 0.5f     // Penetration left alone so resting contacts stay in contact (pixels)
+#define SI_RESTITUTION_THRESHOLD 100.0f   // Slower approaches do not bounce (pixels/s, = 1 m/s)
+
 // Returns 1 if colliding, 0 otherwise. Fills `out` with collision data.
-int collision_detect_circles(const Body *a, const Body *b, Collision *out);
+// pa/pb are the circles' centers.
+int collision_detect_circles(const Body *a, Vec2 pa, const Body *b, Vec2 pb, Collision *out);
+
+// Circle-circle narrowphase for `count` pairs (bodies[body_a[k]], bodies[body_b[k]]) at once,
+// centers read from the positions stream. out[k] gets the same result as
+// collision_detect_circles, with body_a/body_b set, or point_count = 0 when the circles
+// are apart. Uses AVX2 (8 pairs per pass) when the CPU has it.
+void collision_detect_circles_batch(const Body *bodies, const Vec2 *positions, const int *body_a,
+                                    const int *body_b, int count, Collision *out);
+
+// Returns 1 if colliding, 0 otherwise. Circle must be first parameter, centered at
+// circle_position. rect_xf is the rect's cached transform (world_get_transform), which
+// also gives its pose; axis-aligned rects (rect_xf->axis_aligned) take a plain
+// circle-vs-AABB path with no rotations.
+int collision_detect_circle_rect(const Body *circle, Vec2 circle_position, const Body *rect,
+                                 const BodyTransform *rect_xf, Collision *out);
+
+// Rect-rect SAT axis hints (see collision_detect_rects): axes 0-3 are A's right and up,
+// then B's right and up
+#define SAT_AXIS_NONE -1       // No hint yet: test the axes in order
+#define SAT_AXIS_TOUCHING 4    // Added to the least-overlap axis of pairs that collided
+
+// Returns 1 if colliding, 0 otherwise. Uses Separating Axis Theorem (SAT), then clips
+// the incident face against the reference face for up to two contact points.
+// xa/xb are the cached transforms of the two rects (world_get_transform), which hold
+// everything the test needs. Axes of axis-aligned rects are projected from their AABBs,
+// and two axis-aligned rects only test x and y.
+// sat_axis (may be NULL) caches the SAT axis per pair across steps. On entry it names
+// the axis to test first (SAT_AXIS_NONE = no hint); on return it holds the axis that
+// separated the rects, or SAT_AXIS_TOUCHING + the axis of least overlap when they
+// collide. The result does not depend on it.
+int collision_detect_rects(const BodyTransform *xa, const BodyTransform *xb, int *sat_axis, Collision *out);
 
-// Returns 1 if colliding, 0 otherwise. Circle must be first parameter.
-int collision_detect_circle_rect(const Body *circle, const Body *rect, Collision *out);
+// Rect-rect narrowphase for `count` pairs (body_a[k], body_b[k]) at once, reading each
+// body's cached transform from transforms[] (must be up to date).
+// out[k] gets the same result as collision_detect_rects, with body_a/body_b set, or
+// point_count = 0 when the rects are apart. With AVX2 the separating axis test runs on
+// 8 pairs per pass; only overlapping pairs are clipped one by one.
+// sat_axis[k] is pair k's axis hint, updated as in collision_detect_rects.
+void collision_detect_rects_batch(const BodyTransform *transforms, const int *body_a, const int *body_b,
+                                  int *sat_axis, int count, Collision *out);
 
-// Returns 1 if colliding, 0 otherwise. Uses Separating Axis Theorem (SAT).
-int collision_detect_rects(const Body *a, const Body *b, Collision *out);
+// Remember the body poses (pa, pb) a freshly detected collision was computed for.
+// Starts with no accumulated impulse.
+void contact_manifold_init(ContactManifold *m, Vec2 pa, Vec2 pb);
 
-// Resolve collision with impulse-based response and positional correction.
+// Apply impulse j along `normal` at world point `contact` (B pushed along the normal, A against it)
+void collision_apply_impulse(const SolverBody *a, const SolverBody *b, Vec2 contact, Vec2 normal, float j);
+
+// Update penetrations and contact points from the bodies' motion since detection
+// (pa, pb are their positions now). Penetration <= 0 means the bodies have separated at that point.
+void contact_manifold_update(ContactManifold *m, Vec2 pa, Vec2 pb);
+
+// Resolve collision with impulse-based response at each manifold point, then positional correction.
+// Impulses are accumulated per point in m->normal_impulse and clamped so the total never pulls.
 // Modifies velocities and positions of bodies a and b.
-void collision_resolve(Body *a, Body *b, Collision *col);
+// Returns the largest normal velocity change made at any point (pixels/s), the iteration's velocity error.
+float collision_resolve(const SolverBody *a, const SolverBody *b, ContactManifold *m);
+
+// Sequential impulse: precompute each point's effective mass and velocity bias for the step.
+// Call once after detection and before the warm start is applied (restitution is judged on
+// the approach velocity), then collision_solve_contact per iteration.
+void contact_manifold_prepare(ContactManifold *m, const SolverBody *a, const SolverBody *b, float dt);
+
+// Sequential impulse: one velocity pass over the manifold's points. Each point's accumulated
+// impulse is clamped to >= 0; positions are never touched (the bias recovers penetration).
+// Returns the largest normal velocity change made at any point (pixels/s).
+float collision_solve_contact(const SolverBody *a, const SolverBody *b, ContactManifold *m);
+
+// Human-readable name for logs, scene files and benchmarks
+const char *solver_name(SolverType type);
 
 #endif // COLLISION_H
@@ -127,9 +127,10 @@ StepResult env_step(Env* env, Action action) {
     // --- Termination Condition 1: Ball hit the floor (catastrophic failure) ---
     // Check if ball has fallen to the bottom boundary
     if (world) {
-        // Get ball body (hardcoded convention: ball is body 1)
+        // Get ball body (hardcoded convention: ball is body id 1, see world_find_body)
         const int BALL_BODY_INDEX = 1;
-        Body* ball = world_get_body(world, BALL_BODY_INDEX);
+        int ball_index = world_find_body(world, BALL_BODY_INDEX);
+        Body* ball = world_get_body(world, ball_index);
         
         if (ball) {
             // Get ball radius for proper collision detection
@@ -138,7 +139,7 @@ StepResult env_step(Env* env, Action action) {
             
             // Ball hits floor when its bottom edge reaches or passes the floor
             // Add small tolerance (1 pixel) to avoid numerical issues
-            if (ball->position.y + ball_radius >= world->bound_bottom - 1.0f) {
+            if (world_get_position(world, ball_index).y + ball_radius >= world->bound_bottom - 1.0f) {
                 result.terminated = 1;
                 result.truncated = 0;
                 
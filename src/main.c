@@ -28,25 +28,28 @@
 
 static void apply_actuator_pose(World *world, float angle) {
     if (world->actuator_body_index < 0) return;
-    Body *beam = world_get_body(world, world->actuator_body_index);
+    int beam_index = world->actuator_body_index;
+    Body *beam = world_get_body(world, beam_index);
     if (!beam || beam->shape.type != SHAPE_RECT) return;
 
-    Body *base = world_get_body(world, 0);
+    int base_index = world_find_body(world, 0);   // First body in the scene
+    Body *base = world_get_body(world, base_index);
     int use_fulcrum = (base && base != beam && base->shape.type == SHAPE_RECT);
 
     if (use_fulcrum) {
         float h_base = base->shape.rect.height;
         float h_beam = beam->shape.rect.height;
-        float pivot_y = base->position.y - h_base * 0.5f;
+        Vec2 base_position = world_get_position(world, base_index);
+        float pivot_y = base_position.y - h_base * 0.5f;
         float beam_y = pivot_y - h_beam * 0.5f;
-        beam->position.x = base->position.x;
-        beam->position.y = beam_y;
+        world_set_position(world, beam_index, vec2(base_position.x, beam_y));
     } else {
-        beam->position = world->actuator_pivot;
+        world_set_position(world, beam_index, world->actuator_pivot);
     }
-    beam->angle = angle;
-    beam->velocity = VEC2_ZERO;
-    beam->angular_velocity = 0.0f;
+    world_set_angle(world, beam_index, angle);
+    world_set_velocity(world, beam_index, VEC2_ZERO);
+    world_set_angular_velocity(world, beam_index, 0.0f);
+    if (body_is_static(beam)) world_invalidate_statics(world);  // Static index holds the old pose
 }
 
 int main(int argc, char *argv[]) {
@@ -94,6 +97,7 @@ int main(int argc, char *argv[]) {
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) running = 0;
             if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_R) {
+                world_destroy(&world);
                 if (scene_load("scenes/fulcrum.json", &world) == 0) {
                     world.dt = SIM_DT;
                     beam_angle = 0.0f;
@@ -137,6 +141,7 @@ int main(int argc, char *argv[]) {
 
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
+    world_destroy(&world);
     SDL_Quit();
     return 0;
 }
@@ -0,0 +1,151 @@
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "world.h"
+#include "scene.h"
+
+// Headless physics benchmark: steps a scene once per broadphase and reports throughput.
+// Usage: ./bench [scene.json] [steps] [solver] [reorder_interval] [threads] [coloring]
+// Every run starts from a fresh scene load, so final states are directly comparable.
+// The final kinetic energy shows how well the scene came to rest (compare solvers at equal stability).
+// Each broadphase runs a second time with Z-order body reordering every reorder_interval
+// steps (0 = skip) and reports its speedup. Reordering changes the solver order, so
+// checksums only agree among runs of the same mode. Thread count (default 1, 0 = one per
+// core) never changes results, only speed. coloring = 1 solves contacts color by color
+// (world_set_solver_coloring); the default 0 keeps the scene's setting.
+// With several threads and no coloring, "balance" is the busiest thread's island solve
+// time over the mean of all threads (1.00 = perfectly even, "-" = islands not used).
+
+#define BENCH_DT (1.0f / 240.0f)   // Same fixed timestep as main_sim.c
+#define DEFAULT_STEPS 2000
+#define DEFAULT_REORDER_INTERVAL 64
+
+// Sum of body positions: cheap fingerprint to check that broadphases agree
+static double position_checksum(World *w) {
+    double sum = 0.0;
+    for (int i = 0; i < w->body_count; i++) {
+        Vec2 p = world_get_position(w, i);
+        sum += p.x + p.y;
+    }
+    return sum;
+}
+
+// Total linear + angular kinetic energy of the dynamic bodies
+static double kinetic_energy(World *w) {
+    double ke = 0.0;
+    for (int i = 0; i < w->body_count; i++) {
+        Body *b = world_get_body(w, i);
+        if (body_is_static(b)) continue;
+        float angular_velocity = world_get_angular_velocity(w, i);
+        ke += 0.5 * b->mass * vec2_len_sq(world_get_velocity(w, i));
+        if (b->inv_inertia > 0.0f) {
+            ke += 0.5 * (angular_velocity * angular_velocity) / b->inv_inertia;
+        }
+    }
+    return ke;
+}
+
+// Load the scene, step it with the given settings and print one table row.
+// Returns steps per second, or -1 if the scene failed to load.
+static double run(World *world, const char *scene_path, BroadphaseType type, SolverType solver,
+                  int steps, int reorder_interval, int threads, int coloring, double baseline) {
+    if (scene_load(scene_path, world) != 0) {
+        fprintf(stderr, "Failed to load scene: %s\n", scene_path);
+        return -1.0;
+    }
+    world->dt = BENCH_DT;
+    world_set_broadphase(world, type);
+    world_set_solver(world, solver);
+    world_set_reordering(world, reorder_interval);
+    world_set_threads(world, threads);
+    if (coloring) world_set_solver_coloring(world, 1);
+    world_set_profiling(world, 1);
+
+    long long total_pairs = 0;
+    long long total_iterations = 0;
+    long long total_awake = 0;
+    int thread_count = task_pool_thread_count(world->tasks);
+    Uint64 *thread_ticks = (Uint64 *)calloc((size_t)thread_count, sizeof(Uint64));
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < steps; i++) {
+        world_step(world);
+        total_pairs += world->stats.candidate_pairs;
+        total_iterations += world->stats.solver_iterations;
+        total_awake += world->stats.awake_bodies;
+        for (int t = 0; thread_ticks && world->thread_ticks && t < thread_count; t++) {
+            thread_ticks[t] += world->thread_ticks[t];
+        }
+    }
+    Uint64 end = SDL_GetPerformanceCounter();
+
+    // Island load balance: busiest thread over the mean
+    Uint64 busiest = 0, island_ticks = 0;
+    for (int t = 0; thread_ticks && t < thread_count; t++) {
+        if (thread_ticks[t] > busiest) busiest = thread_ticks[t];
+        island_ticks += thread_ticks[t];
+    }
+    free(thread_ticks);
+    char balance[16] = "-";
+    if (thread_count > 1 && island_ticks > 0) {
+        snprintf(balance, sizeof(balance), "%.2f", (double)busiest * thread_count / (double)island_ticks);
+    }
+
+    double seconds = (double)(end - start) / (double)SDL_GetPerformanceFrequency();
+    char name[32];
+    snprintf(name, sizeof(name), "%s%s", broadphase_name(type), reorder_interval > 0 ? "+zorder" : "");
+    printf("%-20s %12.1f %12.2f %10.1f %10.2f %10.1f %10d %16.3f %14.3f %8s",
+           name,
+           steps / seconds,
+           seconds * 1e6 / steps,
+           (double)total_pairs / steps,
+           (double)total_iterations / steps,
+           (double)total_awake / steps,
+           world->contact_peak,
+           position_checksum(world),
+           kinetic_energy(world),
+           balance);
+    if (baseline > 0.0) printf(" %8.2fx", (steps / seconds) / baseline);
+    printf("\n");
+    world_destroy(world);
+    return steps / seconds;
+}
+
+int main(int argc, char *argv[]) {
+    const char *scene_path = (argc > 1) ? argv[1] : "scenes/ball_pit.json";
+    int steps = (argc > 2) ? atoi(argv[2]) : DEFAULT_STEPS;
+    if (steps <= 0) steps = DEFAULT_STEPS;
+
+    int solver = SOLVER_RELAXATION;
+    if (argc > 3) {
+        for (solver = 0; solver < SOLVER_COUNT; solver++) {
+            if (strcmp(argv[3], solver_name((SolverType)solver)) == 0) break;
+        }
+        if (solver == SOLVER_COUNT) {
+            fprintf(stderr, "Unknown solver: %s\n", argv[3]);
+            return 1;
+        }
+    }
+    int reorder_interval = (argc > 4) ? atoi(argv[4]) : DEFAULT_REORDER_INTERVAL;
+    int threads = (argc > 5) ? atoi(argv[5]) : 1;
+    int coloring = (argc > 6) ? atoi(argv[6]) : 0;
+
+    World world;
+
+    printf("Scene: %s | Steps: %d | dt: %.6f | Solver: %s%s | Reorder every: %d | Threads: %d\n", scene_path, steps,
+           BENCH_DT, solver_name((SolverType)solver), coloring ? " (colored)" : "", reorder_interval, threads);
+    printf("%-20s %12s %12s %10s %10s %10s %10s %16s %14s %8s %9s\n",
+           "broadphase", "steps/s", "us/step", "avg pairs", "avg iters", "avg awake", "peak cont",
+           "checksum", "final KE", "balance", "speedup");
+
+    for (int type = 0; type < BROADPHASE_COUNT; type++) {
+        double base = run(&world, scene_path, (BroadphaseType)type, (SolverType)solver, steps, 0, threads, coloring, 0.0);
+        if (base < 0.0) return 1;
+        if (reorder_interval > 0 &&
+            run(&world, scene_path, (BroadphaseType)type, (SolverType)solver, steps, reorder_interval, threads, coloring, base) < 0.0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
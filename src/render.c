@@ -220,9 +220,9 @@ void render_contact_debug(SDL_Renderer *r, float contact_x, float contact_y,
     }
 }
 
-void render_body(SDL_Renderer *r, const Body *b) {
-    float cx = b->position.x;
-    float cy = b->position.y;
+void render_body(SDL_Renderer *r, const Body *b, Vec2 position, float angle) {
+    float cx = position.x;
+    float cy = position.y;
     SDL_Color outline = {255, 255, 255, 255};
 
     if (b->shape.type == SHAPE_CIRCLE) {
@@ -236,7 +236,6 @@ void render_body(SDL_Renderer *r, const Body *b) {
     } else if (b->shape.type == SHAPE_RECT) {
         float width = b->shape.rect.width;
         float height = b->shape.rect.height;
-        float angle = b->angle;
         
         // Filled rectangle with body color (rotated)
         render_rect_rotated_filled(r, cx, cy, width, height, angle, b->color);
@@ -246,18 +245,19 @@ void render_body(SDL_Renderer *r, const Body *b) {
     }
 }
 
-void render_body_debug(SDL_Renderer *r, const Body *b, int show_velocity) {
+void render_body_debug(SDL_Renderer *r, const Body *b, Vec2 position, float angle,
+                       Vec2 velocity, int show_velocity) {
     // Draw the body itself
-    render_body(r, b);
+    render_body(r, b, position, angle);
     
     if (show_velocity && !body_is_static(b)) {
         float vel_scale = 1.0f;
         SDL_Color yellow = {255, 255, 0, 255};
-        render_arrow(r, (int)b->position.x, (int)b->position.y,
-                     b->velocity.x * vel_scale, b->velocity.y * vel_scale, yellow);
+        render_arrow(r, (int)position.x, (int)position.y,
+                     velocity.x * vel_scale, velocity.y * vel_scale, yellow);
     }
 
     // Draw center point
     SDL_Color center_color = {255, 255, 255, 255};
-    render_point(r, (int)b->position.x, (int)b->position.y, 4, center_color);
+    render_point(r, (int)position.x, (int)position.y, 4, center_color);
 }
@@ -2,6 +2,7 @@
 #define RENDER_H
 
 #include <SDL.h>
+#include "vec2.h"
 
 // Forward declaration to avoid circular include
 typedef struct Body Body;
@@ -20,7 +21,9 @@ void render_contact_debug(SDL_Renderer *r, float contact_x, float contact_y,
                           float normal_x, float normal_y, float penetration);
 
 // Body rendering functions
-void render_body(SDL_Renderer *r, const Body *b);
-void render_body_debug(SDL_Renderer *r, const Body *b, int show_velocity);  // Also draws velocity vector
+// The body's pose and velocity live in World's streams, so they are passed alongside it
+void render_body(SDL_Renderer *r, const Body *b, Vec2 position, float angle);
+void render_body_debug(SDL_Renderer *r, const Body *b, Vec2 position, float angle,
+                       Vec2 velocity, int show_velocity);  // Also draws velocity vector
 
 #endif
@@ -5,6 +5,20 @@
 #include <stdlib.h>
 #include <string.h>
 
+// Mutex guarding cJSON's global error state (see scene_load), created by the first
+// load and kept for the life of the process. NULL if it cannot be created.
+static SDL_mutex *parse_lock(void) {
+    static void *lock = NULL;
+    SDL_mutex *mutex = (SDL_mutex *)SDL_AtomicGetPtr(&lock);
+    if (mutex) return mutex;
+    mutex = SDL_CreateMutex();
+    if (mutex && !SDL_AtomicCASPtr(&lock, NULL, mutex)) {
+        SDL_DestroyMutex(mutex);  // Another thread created it first
+        mutex = (SDL_mutex *)SDL_AtomicGetPtr(&lock);
+    }
+    return mutex;
+}
+
 // Helper: Read entire file into string
 static char* read_file(const char *filepath) {
     FILE *file = fopen(filepath, "r");
@@ -72,6 +86,15 @@ static int parse_color(const cJSON *item, SDL_Color *out) {
     return 0;
 }
 
+// Helper: Parse a 32-bit collision bit field (category or mask) from a JSON number
+static int parse_bits(const cJSON *item, unsigned int *out) {
+    if (!cJSON_IsNumber(item) || item->valuedouble < 0.0 || item->valuedouble > 4294967295.0) {
+        return -1;
+    }
+    *out = (unsigned int)item->valuedouble;
+    return 0;
+}
+
 // Helper: Parse world configuration
 static int parse_world_config(const cJSON *world_obj, World *world) {
     // Parse gravity
@@ -107,11 +130,68 @@ static int parse_world_config(const cJSON *world_obj, World *world) {
         }
     }
 
+    // Parse broadphase (optional, default set by world_init)
+    cJSON *broadphase = cJSON_GetObjectItem(world_obj, "broadphase");
+    if (broadphase) {
+        int found = 0;
+        if (cJSON_IsString(broadphase)) {
+            for (int type = 0; type < BROADPHASE_COUNT; type++) {
+                if (strcmp(broadphase->valuestring, broadphase_name((BroadphaseType)type)) == 0) {
+                    world_set_broadphase(world, (BroadphaseType)type);
+                    found = 1;
+                    break;
+                }
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "Unknown broadphase, keeping default\n");
+        }
+    }
+
+    // Parse solver (optional, default set by world_init)
+    cJSON *solver = cJSON_GetObjectItem(world_obj, "solver");
+    if (solver) {
+        int found = 0;
+        if (cJSON_IsString(solver)) {
+            for (int type = 0; type < SOLVER_COUNT; type++) {
+                if (strcmp(solver->valuestring, solver_name((SolverType)type)) == 0) {
+                    world_set_solver(world, (SolverType)type);
+                    found = 1;
+                    break;
+                }
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "Unknown solver, keeping default\n");
+        }
+    }
+
+    // Parse colored solving (optional, default off)
+    cJSON *coloring = cJSON_GetObjectItem(world_obj, "solver_coloring");
+    if (coloring && cJSON_IsBool(coloring)) {
+        world_set_solver_coloring(world, cJSON_IsTrue(coloring));
+    }
+
+    // Parse sleeping (optional, default off)
+    cJSON *sleeping = cJSON_GetObjectItem(world_obj, "sleeping");
+    if (sleeping && cJSON_IsBool(sleeping)) {
+        world_set_sleeping(world, cJSON_IsTrue(sleeping));
+    }
+
     return 0;
 }
 
+// Pose and velocity of a parsed body: World keeps these apart from Body, so they are
+// set through world_set_velocity and friends once the body is added
+typedef struct {
+    Vec2 position;
+    Vec2 velocity;
+    float angle;
+    float angular_velocity;
+} BodyState;
+
 // Helper: Parse a single body from JSON
-static int parse_body(const cJSON *body_obj, Body *out) {
+static int parse_body(const cJSON *body_obj, Body *out, BodyState *state) {
     // Get type (required)
     cJSON *type = cJSON_GetObjectItem(body_obj, "type");
     if (!type || !cJSON_IsString(type)) {
@@ -126,6 +206,10 @@ static int parse_body(const cJSON *body_obj, Body *out) {
         fprintf(stderr, "Body missing or invalid 'position' field\n");
         return -1;
     }
+    state->position = pos;
+    state->velocity = VEC2_ZERO;
+    state->angle = 0.0f;
+    state->angular_velocity = 0.0f;
 
     // Parse based on type
     if (strcmp(type->valuestring, "circle") == 0) {
@@ -147,7 +231,7 @@ static int parse_body(const cJSON *body_obj, Body *out) {
         float rest = restitution && cJSON_IsNumber(restitution) ? (float)restitution->valuedouble : 0.8f;
 
         // Create body
-        *out = body_create_circle(pos, r, m, rest);
+        *out = body_create_circle(r, m, rest);
 
     } else if (strcmp(type->valuestring, "rect") == 0) {
         // Get width and height (required for rect)
@@ -170,7 +254,7 @@ static int parse_body(const cJSON *body_obj, Body *out) {
         float rest = restitution && cJSON_IsNumber(restitution) ? (float)restitution->valuedouble : 0.8f;
 
         // Create body
-        *out = body_create_rect(pos, w, h, m, rest);
+        *out = body_create_rect(w, h, m, rest);
 
     } else {
         fprintf(stderr, "Unknown body type: %s\n", type->valuestring);
@@ -184,20 +268,20 @@ static int parse_body(const cJSON *body_obj, Body *out) {
     if (velocity) {
         Vec2 vel;
         if (parse_vec2(velocity, &vel) == 0) {
-            out->velocity = vel;
+            state->velocity = vel;
         }
     }
 
     // Angular velocity (default 0)
     cJSON *angular_velocity = cJSON_GetObjectItem(body_obj, "angular_velocity");
     if (angular_velocity && cJSON_IsNumber(angular_velocity)) {
-        out->angular_velocity = (float)angular_velocity->valuedouble;
+        state->angular_velocity = (float)angular_velocity->valuedouble;
     }
 
     // Angle (default 0)
     cJSON *angle = cJSON_GetObjectItem(body_obj, "angle");
     if (angle && cJSON_IsNumber(angle)) {
-        out->angle = (float)angle->valuedouble;
+        state->angle = (float)angle->valuedouble;
     }
 
     // Color (default white)
@@ -209,6 +293,28 @@ static int parse_body(const cJSON *body_obj, Body *out) {
         }
     }
 
+    // Collision filter (default: category 1, collides with every category, no group)
+    cJSON *category = cJSON_GetObjectItem(body_obj, "category");
+    if (category) {
+        unsigned int bits;
+        if (parse_bits(category, &bits) == 0) {
+            out->category = bits;
+        }
+    }
+
+    cJSON *mask = cJSON_GetObjectItem(body_obj, "mask");
+    if (mask) {
+        unsigned int bits;
+        if (parse_bits(mask, &bits) == 0) {
+            out->mask = bits;
+        }
+    }
+
+    cJSON *group = cJSON_GetObjectItem(body_obj, "group");
+    if (group && cJSON_IsNumber(group)) {
+        out->group = group->valueint;
+    }
+
     // Static flag (default false)
     cJSON *is_static = cJSON_GetObjectItem(body_obj, "static");
     if (is_static && cJSON_IsTrue(is_static)) {
@@ -225,17 +331,28 @@ int scene_load(const char *filepath, World *world) {
         return -1;
     }
 
-    // Parse JSON
+    // Parse JSON. cJSON keeps the last parse error in a global, so parsing is serialized
+    // to let several simulators load scenes from different threads. Waiting loaders block
+    // on the mutex instead of spinning through someone else's parse.
+    SDL_mutex *lock = parse_lock();
+    if (!lock) {
+        fprintf(stderr, "Failed to create scene parse lock: %s\n", SDL_GetError());
+        free(json_str);
+        return -1;
+    }
+    SDL_LockMutex(lock);
     cJSON *root = cJSON_Parse(json_str);
-    free(json_str);
+    const char *error_ptr = root ? NULL : cJSON_GetErrorPtr();  // Points into json_str
+    SDL_UnlockMutex(lock);
 
     if (!root) {
-        const char *error_ptr = cJSON_GetErrorPtr();
         if (error_ptr) {
             fprintf(stderr, "JSON parse error before: %s\n", error_ptr);
         }
+        free(json_str);
         return -1;
     }
+    free(json_str);
 
     // Parse world configuration
     cJSON *world_obj = cJSON_GetObjectItem(root, "world");
@@ -253,7 +370,14 @@ int scene_load(const char *filepath, World *world) {
     cJSON *bodies = cJSON_GetObjectItem(root, "bodies");
     if (bodies && cJSON_IsArray(bodies)) {
         int body_count = cJSON_GetArraySize(bodies);
-        
+        // Size the world for exactly this scene; world_add_body grows it if bodies come later
+        if (world_reserve_bodies(world, body_count) != 0) {
+            fprintf(stderr, "Out of memory reserving %d bodies\n", body_count);
+            world_destroy(world);   // Buffers that did grow
+            cJSON_Delete(root);
+            return -1;
+        }
+
         for (int i = 0; i < body_count; i++) {
             cJSON *body_obj = cJSON_GetArrayItem(bodies, i);
             if (!cJSON_IsObject(body_obj)) {
@@ -262,15 +386,20 @@ int scene_load(const char *filepath, World *world) {
             }
 
             Body body;
-            if (parse_body(body_obj, &body) == 0) {
-                if (world_add_body(world, body) != -1) {
+            BodyState state;
+            if (parse_body(body_obj, &body, &state) == 0) {
+                int index = world_add_body(world, body, state.position);
+                if (index != -1) {
+                    world_set_velocity(world, index, state.velocity);
+                    world_set_angle(world, index, state.angle);
+                    world_set_angular_velocity(world, index, state.angular_velocity);
                     cJSON *actuator = cJSON_GetObjectItem(body_obj, "actuator");
                     if (actuator && cJSON_IsTrue(actuator)) {
-                        world->actuator_body_index = world->body_count - 1;
-                        world->actuator_pivot = body.position;
+                        world->actuator_body_index = index;
+                        world->actuator_pivot = state.position;
                     }
                 } else {
-                    fprintf(stderr, "Warning: Failed to add body %d (world full?)\n", i);
+                    fprintf(stderr, "Warning: Failed to add body %d (out of memory?)\n", i);
                 }
             } else {
                 fprintf(stderr, "Failed to parse body %d\n", i);
@@ -278,6 +407,9 @@ int scene_load(const char *filepath, World *world) {
         }
     }
 
+    // Static bodies are fixed from here on: index them once
+    broadphase_build_statics(world);
+
     cJSON_Delete(root);
     // printf("Scene loaded: %s\n", filepath);  // Debug output disabled
     return 0;
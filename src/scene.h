@@ -4,7 +4,8 @@
 #include "world.h"
 
 // Load a scene from a JSON file and populate the world
-// Returns 0 on success, -1 on failure
+// Returns 0 on success, -1 on failure. A failed load leaves nothing allocated in the
+// world, so the caller has nothing to destroy.
 int scene_load(const char *filepath, World *world);
 
 #endif // SCENE_H
@@ -24,25 +24,28 @@
 // Helper: apply actuator pose (matches main.c logic exactly)
 static void apply_actuator_pose(World *world, float angle) {
     if (world->actuator_body_index < 0) return;
-    Body *beam = world_get_body(world, world->actuator_body_index);
+    int beam_index = world->actuator_body_index;
+    Body *beam = world_get_body(world, beam_index);
     if (!beam || beam->shape.type != SHAPE_RECT) return;
 
-    Body *base = world_get_body(world, 0);
+    int base_index = world_find_body(world, 0);   // First body in the scene
+    Body *base = world_get_body(world, base_index);
     int use_fulcrum = (base && base != beam && base->shape.type == SHAPE_RECT);
 
     if (use_fulcrum) {
         float h_base = base->shape.rect.height;
         float h_beam = beam->shape.rect.height;
-        float pivot_y = base->position.y - h_base * 0.5f;
+        Vec2 base_position = world_get_position(world, base_index);
+        float pivot_y = base_position.y - h_base * 0.5f;
         float beam_y = pivot_y - h_beam * 0.5f;
-        beam->position.x = base->position.x;
-        beam->position.y = beam_y;
+        world_set_position(world, beam_index, vec2(base_position.x, beam_y));
     } else {
-        beam->position = world->actuator_pivot;
+        world_set_position(world, beam_index, world->actuator_pivot);
     }
-    beam->angle = angle;
-    beam->velocity = VEC2_ZERO;
-    beam->angular_velocity = 0.0f;
+    world_set_angle(world, beam_index, angle);
+    world_set_velocity(world, beam_index, VEC2_ZERO);
+    world_set_angular_velocity(world, beam_index, 0.0f);
+    if (body_is_static(beam)) world_invalidate_statics(world);  // Static index holds the old pose
 }
 
 Simulator* sim_create(const char* scene_path, uint32_t seed, float dt, int headless) {
@@ -121,6 +124,7 @@ void sim_destroy(Simulator* sim) {
             }
             SDL_Quit();
         }
+        world_destroy(&sim->world);
         free(sim);
     }
 }
@@ -129,6 +133,7 @@ void sim_reset(Simulator* sim) {
     if (!sim) return;
     
     // Reload scene from JSON (deterministic base state)
+    world_destroy(&sim->world);
     scene_load(sim->scene_path, &sim->world);
     sim->world.dt = sim->dt;
     world_seed(&sim->world, sim->seed);
@@ -150,9 +155,10 @@ void sim_reset(Simulator* sim) {
         return;  // No randomization if beam is invalid
     }
     
-    // Get ball body (hardcoded convention: ball is body 1)
+    // Get ball body (hardcoded convention: ball is body id 1, see world_find_body)
     const int BALL_BODY_INDEX = 1;
-    Body* ball = world_get_body(&sim->world, BALL_BODY_INDEX);
+    int ball_index = world_find_body(&sim->world, BALL_BODY_INDEX);
+    Body* ball = world_get_body(&sim->world, ball_index);
     if (!ball) {
         return;  // No randomization if ball is invalid
     }
@@ -180,11 +186,13 @@ void sim_reset(Simulator* sim) {
     //        random_pos_norm, random_x_offset);
     
     // Add random X offset to the JSON position (Y stays as-is from JSON)
-    ball->position.x += random_x_offset;
+    Vec2 ball_position = world_get_position(&sim->world, ball_index);
+    ball_position.x += random_x_offset;
+    world_set_position(&sim->world, ball_index, ball_position);
     
     // Keep ball velocities at zero (no velocity randomization yet)
-    ball->velocity = VEC2_ZERO;
-    ball->angular_velocity = 0.0f;
+    world_set_velocity(&sim->world, ball_index, VEC2_ZERO);
+    world_set_angular_velocity(&sim->world, ball_index, 0.0f);
 }
 
 // Update actuator dynamics and apply to world
@@ -260,9 +268,10 @@ void sim_get_observation(const Simulator* sim, float* obs_out, int obs_dim) {
     }
     
     // TODO: figure out design for not hardcoding ball body index.
-    // Get ball body (hardcoded convention: ball is body 1)
+    // Get ball body (hardcoded convention: ball is body id 1, see world_find_body)
     const int BALL_BODY_INDEX = 1;
-    const Body* ball = world_get_body((World*)&sim->world, BALL_BODY_INDEX);
+    int ball_index = world_find_body(&sim->world, BALL_BODY_INDEX);
+    const Body* ball = world_get_body((World*)&sim->world, ball_index);
     if (!ball) {
         // Zero out on error
         for (int i = 0; i < SIM_OBS_DIM; i++) {
@@ -280,9 +289,11 @@ void sim_get_observation(const Simulator* sim, float* obs_out, int obs_dim) {
     float s = sinf(beam_angle);
     
     // Compute vector from beam center to ball center (both in world coordinates)
-    // Invariant: Body.position is center of mass in world coordinates
-    float dx = ball->position.x - beam->position.x;
-    float dy = ball->position.y - beam->position.y;
+    // Invariant: world_get_position is the center of mass in world coordinates
+    Vec2 ball_position = world_get_position(&sim->world, ball_index);
+    Vec2 beam_position = world_get_position(&sim->world, sim->world.actuator_body_index);
+    float dx = ball_position.x - beam_position.x;
+    float dy = ball_position.y - beam_position.y;
     
     // Project onto beam's local x-axis
     // Beam local x-axis in world coords: [cos(θ), sin(θ)]
@@ -291,7 +302,8 @@ void sim_get_observation(const Simulator* sim, float* obs_out, int obs_dim) {
     
     // Project ball velocity onto beam axis
     // This gives ball velocity along beam in beam's local frame
-    float vel_along_beam = ball->velocity.x * c + ball->velocity.y * s;
+    Vec2 ball_velocity = world_get_velocity(&sim->world, ball_index);
+    float vel_along_beam = ball_velocity.x * c + ball_velocity.y * s;
     
     // Write observation vector
     obs_out[0] = beam_angle;              // beam angle θ (radians)
@@ -37,6 +37,8 @@ typedef struct {
 
 // Core API
 // headless: 1 = no rendering (no SDL), 0 = create window/renderer for visualization
+// Headless simulators share no state: separate instances can be created, reset and
+// stepped on different threads at the same time, each with deterministic results.
 Simulator* sim_create(const char* scene_path, uint32_t seed, float dt, int headless);
 void sim_destroy(Simulator* sim);
 
@@ -61,9 +63,9 @@ World* sim_get_world(Simulator* sim);
 //   obs_out[3]: ball velocity along beam ẋ, projected onto beam axis (pixels/s)
 //
 // Coordinate assumptions (invariants):
-//   - Body.position is center of mass in world coordinates
-//   - Beam local x-axis is defined by beam->angle (rotated from world +x)
-//   - Ball is at body index 1 (hardcoded convention)
+//   - world_get_position is the center of mass in world coordinates
+//   - Beam local x-axis is defined by the beam's world_get_angle (rotated from world +x)
+//   - Ball is body id 1, the second body in the scene (hardcoded convention)
 //
 // obs_dim: size of obs_out buffer (must be >= SIM_OBS_DIM)
 void sim_get_observation(const Simulator* sim, float* obs_out, int obs_dim);
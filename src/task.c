@@ -0,0 +1,188 @@
+#include "task.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// One job at a time: the poster deals the tasks into per-thread queues, publishes the
+// job under the lock and bumps `generation`; workers that see a new generation join in.
+// Each thread pops its own queue from the front and steals from the back of the others
+// once it is empty; a thread that finds every queue empty is done (jobs never add
+// tasks). A job is only replaced once every worker that joined it has left (busy == 0),
+// so a late worker can never take tasks of the next job with the previous job's function.
+
+// Thread t's queue holds tasks t, t + n, t + 2n, ... (n threads): slots [head, tail)
+// are still to run, slot k being task t + k * n
+typedef struct {
+    SDL_SpinLock lock;
+    int head;    // Next slot the owner runs
+    int tail;    // One past the last slot; thieves take tail - 1
+} TaskQueue;
+
+struct TaskPool {
+    int thread_count;            // Including the thread calling task_pool_run
+    SDL_Thread **threads;
+    TaskQueue *queues;           // One per thread
+    SDL_mutex *lock;
+    SDL_cond *wake;              // Signalled when a job is posted or the pool stops
+    SDL_cond *done;              // Signalled when a worker leaves a job
+    int generation;              // Jobs posted so far
+    int stopping;
+    int busy;                    // Workers currently inside a job
+
+    // Current job (written under the lock while busy == 0)
+    TaskFunction fn;
+    void *context;
+    int task_count;
+    int finished;                // Tasks completed
+};
+
+typedef struct {
+    TaskPool *pool;
+    int thread;
+} WorkerArgs;
+
+// Take the next task from thread `owner`'s queue: the front for its owner, the
+// back for a thief. Returns -1 if the queue is empty.
+static int take_task(TaskPool *pool, int owner, int steal) {
+    TaskQueue *q = &pool->queues[owner];
+    int slot = -1;
+    SDL_AtomicLock(&q->lock);
+    if (q->head < q->tail) slot = steal ? --q->tail : q->head++;
+    SDL_AtomicUnlock(&q->lock);
+    return (slot < 0) ? -1 : owner + slot * pool->thread_count;
+}
+
+// Run tasks of the current job, own queue first, then stolen ones, until every queue
+// is empty. Returns how many ran.
+static int run_tasks(TaskPool *pool, TaskFunction fn, void *context, int thread) {
+    int ran = 0;
+    for (;;) {
+        int task = take_task(pool, thread, 0);
+        for (int k = 1; task < 0 && k < pool->thread_count; k++) {
+            task = take_task(pool, (thread + k) % pool->thread_count, 1);
+        }
+        if (task < 0) break;
+        fn(context, task, thread);
+        ran++;
+    }
+    return ran;
+}
+
+static int worker_main(void *data) {
+    WorkerArgs args = *(WorkerArgs *)data;
+    free(data);
+    TaskPool *pool = args.pool;
+
+    SDL_LockMutex(pool->lock);
+    int seen = pool->generation;
+    for (;;) {
+        while (!pool->stopping && pool->generation == seen) {
+            SDL_CondWait(pool->wake, pool->lock);
+        }
+        if (pool->stopping) break;
+        seen = pool->generation;
+
+        // Copy the job while holding the lock; it cannot change until busy drops to 0
+        TaskFunction fn = pool->fn;
+        void *context = pool->context;
+        pool->busy++;
+        SDL_UnlockMutex(pool->lock);
+
+        int ran = run_tasks(pool, fn, context, args.thread);
+
+        SDL_LockMutex(pool->lock);
+        pool->finished += ran;
+        pool->busy--;
+        SDL_CondBroadcast(pool->done);
+    }
+    SDL_UnlockMutex(pool->lock);
+    return 0;
+}
+
+TaskPool *task_pool_create(int thread_count) {
+    if (thread_count < 1) thread_count = 1;
+    TaskPool *pool = (TaskPool *)calloc(1, sizeof(TaskPool));
+    if (!pool) return NULL;
+    pool->thread_count = 1;  // Raised as workers start
+    pool->threads = (SDL_Thread **)calloc((size_t)thread_count, sizeof(SDL_Thread *));
+    pool->queues = (TaskQueue *)calloc((size_t)thread_count, sizeof(TaskQueue));
+    pool->lock = SDL_CreateMutex();
+    pool->wake = SDL_CreateCond();
+    pool->done = SDL_CreateCond();
+    if (!pool->threads || !pool->queues || !pool->lock || !pool->wake || !pool->done) {
+        task_pool_destroy(pool);
+        return NULL;
+    }
+
+    for (int t = 1; t < thread_count; t++) {
+        WorkerArgs *args = (WorkerArgs *)malloc(sizeof(WorkerArgs));
+        if (!args) break;
+        args->pool = pool;
+        args->thread = t;
+        pool->threads[t] = SDL_CreateThread(worker_main, "physics", args);
+        if (!pool->threads[t]) {
+            fprintf(stderr, "Failed to start worker thread: %s\n", SDL_GetError());
+            free(args);
+            break;
+        }
+        pool->thread_count = t + 1;
+    }
+    if (pool->thread_count < thread_count) {
+        task_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void task_pool_destroy(TaskPool *pool) {
+    if (!pool) return;
+    if (pool->lock) {
+        SDL_LockMutex(pool->lock);
+        pool->stopping = 1;
+        SDL_CondBroadcast(pool->wake);
+        SDL_UnlockMutex(pool->lock);
+    }
+    for (int t = 1; t < pool->thread_count; t++) {
+        SDL_WaitThread(pool->threads[t], NULL);
+    }
+    SDL_DestroyCond(pool->done);
+    SDL_DestroyCond(pool->wake);
+    SDL_DestroyMutex(pool->lock);
+    free(pool->threads);
+    free(pool->queues);
+    free(pool);
+}
+
+int task_pool_thread_count(const TaskPool *pool) {
+    return pool ? pool->thread_count : 1;
+}
+
+void task_pool_run(TaskPool *pool, TaskFunction fn, void *context, int task_count) {
+    if (!pool || pool->thread_count == 1 || task_count <= 1) {
+        for (int task = 0; task < task_count; task++) fn(context, task, 0);
+        return;
+    }
+
+    // Wait for workers still leaving the previous job, then deal and publish this one
+    SDL_LockMutex(pool->lock);
+    while (pool->busy > 0) SDL_CondWait(pool->done, pool->lock);
+    int n = pool->thread_count;
+    for (int t = 0; t < n; t++) {
+        pool->queues[t].head = 0;
+        pool->queues[t].tail = (t < task_count) ? (task_count - t + n - 1) / n : 0;
+    }
+    pool->fn = fn;
+    pool->context = context;
+    pool->task_count = task_count;
+    pool->finished = 0;
+    pool->generation++;
+    SDL_CondBroadcast(pool->wake);
+    SDL_UnlockMutex(pool->lock);
+
+    int ran = run_tasks(pool, fn, context, 0);
+
+    SDL_LockMutex(pool->lock);
+    pool->finished += ran;
+    while (pool->finished < task_count) SDL_CondWait(pool->done, pool->lock);
+    SDL_UnlockMutex(pool->lock);
+}
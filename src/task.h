@@ -0,0 +1,34 @@
+#ifndef TASK_H
+#define TASK_H
+
+// Work-stealing scheduler for splitting one world step across cores.
+// A job is a fixed number of independent tasks; task_pool_run deals them out to the
+// workers and the calling thread, and returns once every task has finished. Each
+// thread works through its own queue and steals from the others when it runs dry, so
+// a few large tasks (a big island next to many small ones) do not leave threads idle.
+// Tasks only write to their own output ranges (or per-thread scratch), so results
+// never depend on which thread ran what.
+
+// Run task `task` of a job. `thread` is 0 for the calling thread, 1..thread_count-1 for
+// workers: use it to pick per-thread scratch buffers.
+typedef void (*TaskFunction)(void *context, int task, int thread);
+
+typedef struct TaskPool TaskPool;
+
+// Start a pool of `thread_count` threads in total (the caller counts as one, so
+// thread_count - 1 workers are created). Returns NULL if threads cannot be created.
+TaskPool *task_pool_create(int thread_count);
+
+// Stop and join the workers. Accepts NULL.
+void task_pool_destroy(TaskPool *pool);
+
+// Threads that may run tasks, including the caller (1 for a NULL pool)
+int task_pool_thread_count(const TaskPool *pool);
+
+// Run tasks 0..task_count-1 of `fn` and wait for all of them. Thread t starts with
+// tasks t, t + n, t + 2n, ... (n threads) in that order, so put the largest tasks
+// first. With a NULL pool, or a single task, everything runs inline on the calling
+// thread (as thread 0).
+void task_pool_run(TaskPool *pool, TaskFunction fn, void *context, int task_count);
+
+#endif // TASK_H
@@ -1,17 +1,104 @@
 #include "world.h"
 #include "render.h"
 #include "collision.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <math.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define BOUNDS_INSIDE_SLACK 0.01f   // Pixels; rect AABBs closer to a wall take the corner test
 
 void world_init(World *w, Vec2 gravity, float dt) {
+    // Nothing allocated yet: the first reservation sizes every per-body buffer
+    w->bodies = NULL;
+    w->transforms = NULL;
+    w->position = NULL;
+    w->velocity = NULL;
+    w->angle = NULL;
+    w->angular_velocity = NULL;
+    w->moving = NULL;
+    w->bound_radius = NULL;
+    w->body_id = NULL;
+    w->reorder_keys = NULL;
+    w->reorder_from = NULL;
+    w->reorder_to = NULL;
+    w->reorder_slots = NULL;
+    w->body_index = NULL;
+    w->solver_positions = NULL;
+    w->body_moved = NULL;
+    w->asleep = NULL;
+    w->sleep_time = NULL;
+    w->sleep_next = NULL;
+    w->sleep_position = NULL;
+    w->sleep_angle = NULL;
+    w->island_parent = NULL;
+    w->island_rest = NULL;
+    w->body_capacity = 0;
+    w->pairs = NULL;
+    w->pair_capacity = 0;
+    memset(&w->statics, 0, sizeof(w->statics));
+    memset(&w->spatial_hash, 0, sizeof(w->spatial_hash));
+    memset(&w->sap, 0, sizeof(w->sap));
+    memset(&w->aabb_tree, 0, sizeof(w->aabb_tree));
+    memset(&w->hgrid, 0, sizeof(w->hgrid));
+
     w->body_count = 0;
+    w->reorder_interval = 0;
+    w->steps_since_reorder = 0;
     w->gravity = gravity;
     w->dt = dt;
     w->bounds_enabled = 0;
     w->actuator_body_index = -1;
     w->actuator_pivot = (Vec2){0.0f, 0.0f};
 
+    // Broadphase: spatial hash by default, cell size picked from body extents
+    w->broadphase = BROADPHASE_SPATIAL_HASH;
+    w->spatial_hash.cell_size = 0.0f;
+    broadphase_init(w);
+    w->solver = SOLVER_RELAXATION;
+    w->solver_max_iterations = SOLVER_ITERATIONS;
+    w->solver_penetration_tolerance = SOLVER_PENETRATION_TOLERANCE;
+    w->solver_velocity_tolerance = SOLVER_VELOCITY_TOLERANCE;
+    w->solver_coloring = 0;
+    memset(&w->colors, 0, sizeof(w->colors));
+    memset(&w->islands, 0, sizeof(w->islands));
+    w->sleep_enabled = 0;        // Opt in: sleepers stop moving, which changes trajectories
+    w->sleeper_count = 0;
+    w->contacts = NULL;          // Allocated by the first step that finds a contact
+    w->contact_count = 0;
+    w->contact_capacity = 0;
+    w->contact_peak = 0;
+    w->contact_cache = NULL;
+    w->contact_cache_count = 0;
+    w->contact_cache_capacity = 0;
+    w->batches.slot = NULL;
+    w->batches.body_a = NULL;
+    w->batches.body_b = NULL;
+    w->batches.results = NULL;
+    w->batches.sat_axis = NULL;
+    w->batches.capacity = 0;
+    w->sat_cache = NULL;
+    w->sat_cache_count = 0;
+    w->sat_cache_capacity = 0;
+    w->tasks = NULL;             // Single-threaded until world_set_threads
+    w->thread_pairs = NULL;
+    w->thread_passes = NULL;
+    w->thread_ticks = NULL;
+    w->profiling = 0;
+    w->stats.solver_colors = 0;
+    w->stats.solver_islands = 0;
+    w->stats.candidate_pairs = 0;
+    w->stats.contacts = 0;
+    w->stats.solver_iterations = 0;
+    w->stats.penetration_error = 0.0f;
+    w->stats.velocity_error = 0.0f;
+    w->stats.awake_bodies = 0;
+    w->stats.islands = 0;
+
     // Default debug flags (all off)
     w->debug.show_velocity = 0;
     w->debug.show_contacts = 0;
@@ -21,6 +108,96 @@ void world_init(World *w, Vec2 gravity, float dt) {
     world_seed(w, 1);
 }
 
+void world_destroy(World *w) {
+    free(w->bodies);
+    free(w->transforms);
+    free(w->position);
+    free(w->velocity);
+    free(w->angle);
+    free(w->angular_velocity);
+    free(w->moving);
+    free(w->bound_radius);
+    free(w->body_id);
+    free(w->reorder_keys);
+    free(w->reorder_from);
+    free(w->reorder_to);
+    free(w->reorder_slots);
+    free(w->body_index);
+    free(w->solver_positions);
+    free(w->body_moved);
+    free(w->asleep);
+    free(w->sleep_time);
+    free(w->sleep_next);
+    free(w->sleep_position);
+    free(w->sleep_angle);
+    free(w->island_parent);
+    free(w->island_rest);
+    w->bodies = NULL;
+    w->transforms = NULL;
+    w->position = NULL;
+    w->velocity = NULL;
+    w->angle = NULL;
+    w->angular_velocity = NULL;
+    w->moving = NULL;
+    w->bound_radius = NULL;
+    w->body_id = NULL;
+    w->reorder_keys = NULL;
+    w->reorder_from = NULL;
+    w->reorder_to = NULL;
+    w->reorder_slots = NULL;
+    w->body_index = NULL;
+    w->solver_positions = NULL;
+    w->body_moved = NULL;
+    w->asleep = NULL;
+    w->sleep_time = NULL;
+    w->sleep_next = NULL;
+    w->sleep_position = NULL;
+    w->sleep_angle = NULL;
+    w->island_parent = NULL;
+    w->island_rest = NULL;
+    w->body_count = 0;
+    w->body_capacity = 0;
+    free(w->pairs);
+    w->pairs = NULL;
+    w->pair_count = 0;
+    w->pair_capacity = 0;
+    broadphase_destroy(w);
+
+    free(w->contacts);
+    free(w->contact_cache);
+    w->contacts = NULL;
+    w->contact_count = 0;
+    w->contact_capacity = 0;
+    w->contact_cache = NULL;
+    w->contact_cache_count = 0;
+    w->contact_cache_capacity = 0;
+    free(w->batches.slot);
+    free(w->batches.body_a);
+    free(w->batches.body_b);
+    free(w->batches.results);
+    free(w->batches.sat_axis);
+    w->batches.slot = NULL;
+    w->batches.body_a = NULL;
+    w->batches.body_b = NULL;
+    w->batches.results = NULL;
+    w->batches.sat_axis = NULL;
+    w->batches.capacity = 0;
+    free(w->sat_cache);
+    w->sat_cache = NULL;
+    w->sat_cache_count = 0;
+    w->sat_cache_capacity = 0;
+    free(w->colors.color);
+    free(w->colors.order);
+    free(w->colors.body_colors);
+    memset(&w->colors, 0, sizeof(w->colors));
+    free(w->islands.island);
+    free(w->islands.order);
+    free(w->islands.islands);
+    free(w->islands.body_island);
+    memset(&w->islands, 0, sizeof(w->islands));
+    world_set_threads(w, 1);
+}
+
 void world_set_bounds(World *w, float left, float top, float right, float bottom) {
     w->bound_left = left;
     w->bound_top = top;
@@ -29,16 +206,171 @@ void world_set_bounds(World *w, float left, float top, float right, float bottom
     w->bounds_enabled = 1;
 }
 
-int world_add_body(World *w, Body b) {
-    if (w->body_count >= MAX_BODIES) {
-        return -1;  // World is full
+void world_set_broadphase(World *w, BroadphaseType type) {
+    if ((int)type < 0 || type >= BROADPHASE_COUNT) return;
+    w->broadphase = type;
+    broadphase_init(w);
+}
+
+void world_invalidate_statics(World *w) {
+    broadphase_init(w);  // Drops the dynamic split too, so a body changing sides is picked up
+    for (int i = 0; i < w->body_count; i++) {
+        w->moving[i] = !w->asleep[i] && !body_is_static(&w->bodies[i]);
+    }
+}
+
+void world_set_solver(World *w, SolverType type) {
+    if ((int)type < 0 || type >= SOLVER_COUNT) return;
+    w->solver = type;
+}
+
+void world_set_solver_iterations(World *w, int max_iterations, float penetration_tolerance,
+                                 float velocity_tolerance) {
+    if (max_iterations < 1) return;
+    w->solver_max_iterations = max_iterations;
+    w->solver_penetration_tolerance = penetration_tolerance;
+    w->solver_velocity_tolerance = velocity_tolerance;
+}
+
+int world_reserve_bodies(World *w, int capacity) {
+    if (capacity <= w->body_capacity) return 0;
+
+    // Each buffer keeps its old size if its own realloc fails
+    int failed = 0;
+    RESIZE_ARRAY(w->bodies, capacity, failed);
+    RESIZE_ARRAY(w->transforms, capacity, failed);
+    RESIZE_ARRAY(w->position, capacity, failed);
+    RESIZE_ARRAY(w->velocity, capacity, failed);
+    RESIZE_ARRAY(w->angle, capacity, failed);
+    RESIZE_ARRAY(w->angular_velocity, capacity, failed);
+    RESIZE_ARRAY(w->moving, capacity, failed);
+    RESIZE_ARRAY(w->bound_radius, capacity, failed);
+    RESIZE_ARRAY(w->body_id, capacity, failed);
+    RESIZE_ARRAY(w->body_index, capacity, failed);
+    RESIZE_ARRAY(w->reorder_keys, capacity, failed);
+    RESIZE_ARRAY(w->reorder_from, capacity, failed);
+    RESIZE_ARRAY(w->reorder_to, capacity, failed);
+    RESIZE_ARRAY(w->reorder_slots, capacity, failed);
+    RESIZE_ARRAY(w->solver_positions, capacity, failed);
+    RESIZE_ARRAY(w->body_moved, capacity, failed);
+    RESIZE_ARRAY(w->asleep, capacity, failed);
+    RESIZE_ARRAY(w->sleep_time, capacity, failed);
+    RESIZE_ARRAY(w->sleep_next, capacity, failed);
+    RESIZE_ARRAY(w->sleep_position, capacity, failed);
+    RESIZE_ARRAY(w->sleep_angle, capacity, failed);
+    RESIZE_ARRAY(w->island_parent, capacity, failed);
+    RESIZE_ARRAY(w->island_rest, capacity, failed);
+    RESIZE_ARRAY(w->colors.body_colors, capacity, failed);
+    RESIZE_ARRAY(w->islands.body_island, capacity, failed);
+    if (failed || broadphase_reserve(w, capacity) != 0) return -1;
+
+    w->body_capacity = capacity;
+    return 0;
+}
+
+int world_add_body(World *w, Body b, Vec2 position) {
+    if (w->body_count >= w->body_capacity) {
+        int capacity = (w->body_capacity > 0) ? 2 * w->body_capacity : WORLD_INITIAL_CAPACITY;
+        if (world_reserve_bodies(w, capacity) != 0) return -1;  // Out of memory
     }
     int index = w->body_count;
     w->bodies[index] = b;
+    w->transforms[index].valid = 0;
+    w->position[index] = position;
+    w->velocity[index] = VEC2_ZERO;
+    w->angle[index] = 0.0f;
+    w->angular_velocity[index] = 0.0f;
+    w->moving[index] = !body_is_static(&b);
+    w->bound_radius[index] = body_bound_radius(&b);
+    w->asleep[index] = 0;
+    w->sleep_time[index] = 0.0f;
+    w->sleep_next[index] = index;
+    w->body_id[index] = index;
+    w->body_index[index] = index;
     w->body_count++;
     return index;
 }
 
+int world_find_body(const World *w, int id) {
+    if (id < 0 || id >= w->body_count) return -1;
+    return w->body_index[id];
+}
+
+void world_set_reordering(World *w, int interval) {
+    w->reorder_interval = (interval > 0) ? interval : 0;
+    w->steps_since_reorder = 0;
+}
+
+int world_set_threads(World *w, int thread_count) {
+    if (thread_count <= 0) thread_count = SDL_GetCPUCount();
+    if (thread_count == task_pool_thread_count(w->tasks)) return 0;
+
+    // Drop the current pool and its scratch first: a failure leaves the world single-threaded
+    if (w->thread_pairs) {
+        for (int t = 0; t < task_pool_thread_count(w->tasks); t++) free(w->thread_pairs[t].pairs);
+    }
+    free(w->thread_pairs);
+    free(w->thread_passes);
+    free(w->thread_ticks);
+    task_pool_destroy(w->tasks);
+    w->thread_pairs = NULL;
+    w->thread_passes = NULL;
+    w->thread_ticks = NULL;
+    w->tasks = NULL;
+    if (thread_count <= 1) return 0;
+
+    w->thread_pairs = (PairBuffer *)calloc((size_t)thread_count, sizeof(PairBuffer));
+    w->thread_passes = (SolverPass *)calloc((size_t)thread_count, sizeof(SolverPass));
+    w->thread_ticks = (Uint64 *)calloc((size_t)thread_count, sizeof(Uint64));
+    w->tasks = (w->thread_pairs && w->thread_passes && w->thread_ticks) ? task_pool_create(thread_count) : NULL;
+    if (!w->tasks) {
+        fprintf(stderr, "Failed to start %d physics threads, stepping on one\n", thread_count);
+        free(w->thread_pairs);
+        free(w->thread_passes);
+        free(w->thread_ticks);
+        w->thread_pairs = NULL;
+        w->thread_passes = NULL;
+        w->thread_ticks = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+void world_set_profiling(World *w, int enabled) {
+    w->profiling = enabled ? 1 : 0;
+}
+
+void world_set_solver_coloring(World *w, int enabled) {
+    w->solver_coloring = enabled ? 1 : 0;
+    w->colors.dirty = 1;
+}
+
+void world_set_sleeping(World *w, int enabled) {
+    w->sleep_enabled = enabled;
+    if (!enabled) {
+        for (int i = 0; i < w->body_count; i++) {
+            world_wake_body(w, i);
+        }
+    }
+}
+
+void world_wake_body(World *w, int index) {
+    if (index < 0 || index >= w->body_count || !w->asleep[index]) return;
+
+    // Islands sleep and wake as a whole: a woken body would otherwise lean on sleepers.
+    // Walk the island's ring, so waking costs the island's size
+    int i = index;
+    do {
+        int next = w->sleep_next[i];
+        w->asleep[i] = 0;
+        w->sleeper_count--;
+        w->moving[i] = !body_is_static(&w->bodies[i]);
+        w->sleep_time[i] = 0.0f;
+        w->sleep_next[i] = i;
+        i = next;
+    } while (i != index);
+}
+
 Body* world_get_body(World *w, int index) {
     if (index < 0 || index >= w->body_count) {
         return NULL;
@@ -48,106 +380,136 @@ Body* world_get_body(World *w, int index) {
 
 // --- Internal helper functions ---
 
-static void integrate_bodies(World *w) {
-    for (int i = 0; i < w->body_count; i++) {
-        Body *b = &w->bodies[i];
-        
-        if (body_is_static(b)) continue;
-        
-        // Semi-implicit Euler: update velocity first, then position
-        b->velocity = vec2_add(b->velocity, vec2_scale(w->gravity, w->dt));
-        b->position = vec2_add(b->position, vec2_scale(b->velocity, w->dt));
-        
-        // Angular integration (no torque sources yet, but structure supports it)
-        // angular_velocity would be updated by torque here if we had it
+// Simulated this step: dynamic and awake (kept in w->moving)
+static int body_active(const World *w, int i) {
+    return w->moving[i];
+}
 
-        // 1. Integrate angular velocity from torque
-        // b->angular_velocity += b->torque * b->inv_inertia * dt;
+#if defined(__SSE2__)
+// Per-body `moving` bytes i..i+3 as a 4-lane mask (all ones where simulated)
+static __m128 moving_mask4(const unsigned char *moving) {
+    int bytes;
+    memcpy(&bytes, moving, sizeof(bytes));
+    __m128i zero = _mm_setzero_si128();
+    __m128i lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+    return _mm_castsi128_ps(_mm_cmpgt_epi32(lanes, zero));
+}
 
-        // // 2. Integrate angle from angular velocity
-        // b->angle += b->angular_velocity * dt;
+// Keep `old` where the mask is clear
+static __m128 select_ps(__m128 mask, __m128 new_value, __m128 old) {
+    return _mm_or_ps(_mm_and_ps(mask, new_value), _mm_andnot_ps(mask, old));
+}
+#endif
 
-        // // 3. Clear torque
-        // b->torque = 0.0f;
+static void integrate_velocities(World *w) {
+    Vec2 dv = vec2_scale(w->gravity, w->dt);  // Same for every body
+    int i = 0;
 
-        b->angle += b->angular_velocity * w->dt;
+    // Semi-implicit Euler: update velocity first, then position (integrate_positions).
+    // Four bodies per pass over the velocity stream; asleep and static lanes keep theirs.
+#if defined(__SSE2__)
+    __m128 dv2 = _mm_setr_ps(dv.x, dv.y, dv.x, dv.y);
+    for (; i + 4 <= w->body_count; i += 4) {
+        __m128 mask = moving_mask4(&w->moving[i]);
+        float *v = &w->velocity[i].x;
+        __m128 v01 = _mm_loadu_ps(v);
+        __m128 v23 = _mm_loadu_ps(v + 4);
+        _mm_storeu_ps(v, select_ps(_mm_unpacklo_ps(mask, mask), _mm_add_ps(v01, dv2), v01));
+        _mm_storeu_ps(v + 4, select_ps(_mm_unpackhi_ps(mask, mask), _mm_add_ps(v23, dv2), v23));
+    }
+#endif
+    for (; i < w->body_count; i++) {
+        if (!body_active(w, i)) continue;
+        w->velocity[i] = vec2_add(w->velocity[i], dv);
+    }
+
+    // Angular velocity would be integrated from torque here once there are torque sources
+}
+
+static void integrate_positions(World *w) {
+    int i = 0;
+
+#if defined(__SSE2__)
+    __m128 dt = _mm_set1_ps(w->dt);
+    for (; i + 4 <= w->body_count; i += 4) {
+        __m128 mask = moving_mask4(&w->moving[i]);
+        __m128 mask01 = _mm_unpacklo_ps(mask, mask);
+        __m128 mask23 = _mm_unpackhi_ps(mask, mask);
+        float *p = &w->position[i].x;
+        const float *v = &w->velocity[i].x;
+        __m128 p01 = _mm_loadu_ps(p);
+        __m128 p23 = _mm_loadu_ps(p + 4);
+        _mm_storeu_ps(p, select_ps(mask01, _mm_add_ps(p01, _mm_mul_ps(_mm_loadu_ps(v), dt)), p01));
+        _mm_storeu_ps(p + 4, select_ps(mask23, _mm_add_ps(p23, _mm_mul_ps(_mm_loadu_ps(v + 4), dt)), p23));
+
+        __m128 angle = _mm_loadu_ps(&w->angle[i]);
+        __m128 turned = _mm_add_ps(angle, _mm_mul_ps(_mm_loadu_ps(&w->angular_velocity[i]), dt));
+        _mm_storeu_ps(&w->angle[i], select_ps(mask, turned, angle));
+    }
+#endif
+    for (; i < w->body_count; i++) {
+        if (!body_active(w, i)) continue;
+        w->position[i] = vec2_add(w->position[i], vec2_scale(w->velocity[i], w->dt));
+        w->angle[i] += w->angular_velocity[i] * w->dt;
     }
 }
 
 // --- Shape vs Plane helpers ---
 // Boundaries are treated as infinite static planes.
 
-static void resolve_circle_vs_bounds(Body *b, float left, float top, float right, float bottom) {
+static void resolve_circle_vs_bounds(const Body *b, Vec2 *position, Vec2 *velocity,
+                                     float left, float top, float right, float bottom) {
     float radius = b->shape.circle.radius;
     // REST_VEL_EPS: Resting contact threshold (0.05 m/s = 5 pixels/s)
     // Bodies moving slower than this are treated as at rest to prevent jitter
     const float REST_VEL_EPS = 0.05f * PIXELS_PER_METER;  // 5.0 pixels/sec
     
     // Left wall
-    if (b->position.x - radius < left) {
-        b->position.x = left + radius;
-        if (fabsf(b->velocity.x) > REST_VEL_EPS) {
-            b->velocity.x = -b->velocity.x * b->restitution;
+    if (position->x - radius < left) {
+        position->x = left + radius;
+        if (fabsf(velocity->x) > REST_VEL_EPS) {
+            velocity->x = -velocity->x * b->restitution;
         } else {
-            b->velocity.x = 0.0f;  // Kill micro-velocity to prevent jitter
+            velocity->x = 0.0f;  // Kill micro-velocity to prevent jitter
         }
     }
     // Right wall
-    if (b->position.x + radius > right) {
-        b->position.x = right - radius;
-        if (fabsf(b->velocity.x) > REST_VEL_EPS) {
-            b->velocity.x = -b->velocity.x * b->restitution;
+    if (position->x + radius > right) {
+        position->x = right - radius;
+        if (fabsf(velocity->x) > REST_VEL_EPS) {
+            velocity->x = -velocity->x * b->restitution;
         } else {
-            b->velocity.x = 0.0f;
+            velocity->x = 0.0f;
         }
     }
     // Ceiling (top)
-    if (b->position.y - radius < top) {
-        b->position.y = top + radius;
-        if (fabsf(b->velocity.y) > REST_VEL_EPS) {
-            b->velocity.y = -b->velocity.y * b->restitution;
+    if (position->y - radius < top) {
+        position->y = top + radius;
+        if (fabsf(velocity->y) > REST_VEL_EPS) {
+            velocity->y = -velocity->y * b->restitution;
         } else {
-            b->velocity.y = 0.0f;
+            velocity->y = 0.0f;
         }
     }
     // Floor (bottom)
-    if (b->position.y + radius > bottom) {
-        b->position.y = bottom - radius;
-        if (fabsf(b->velocity.y) > REST_VEL_EPS) {
-            b->velocity.y = -b->velocity.y * b->restitution;
+    if (position->y + radius > bottom) {
+        position->y = bottom - radius;
+        if (fabsf(velocity->y) > REST_VEL_EPS) {
+            velocity->y = -velocity->y * b->restitution;
         } else {
-            b->velocity.y = 0.0f;
+            velocity->y = 0.0f;
         }
     }
 }
 
 // Resolve rotated rectangle vs world boundaries (OBB vs planes)
-// Strategy: Compute all 4 rotated corners, check each against boundaries,
+// Strategy: Take the 4 rotated corners, check each against boundaries,
 // find worst penetration, then apply impulse-based collision response.
-// This correctly handles rotated rectangles by using b->angle.
-static void resolve_rect_vs_bounds(Body *b, float left, float top, float right, float bottom) {
-    float half_w = b->shape.rect.width * 0.5f;
-    float half_h = b->shape.rect.height * 0.5f;
-    
-    // Compute the 4 corners of the rotated rectangle (OBB)
-    float cos_angle = cosf(b->angle);
-    float sin_angle = sinf(b->angle);
-    
-    // Local corner offsets (relative to center)
-    Vec2 local_corners[4] = {
-        vec2(-half_w, -half_h),  // Top-left
-        vec2( half_w, -half_h),  // Top-right
-        vec2( half_w,  half_h),  // Bottom-right
-        vec2(-half_w,  half_h)   // Bottom-left
-    };
-    
-    // Transform corners to world space
-    Vec2 world_corners[4];
-    for (int i = 0; i < 4; i++) {
-        float wx = local_corners[i].x * cos_angle - local_corners[i].y * sin_angle;
-        float wy = local_corners[i].x * sin_angle + local_corners[i].y * cos_angle;
-        world_corners[i] = vec2_add(vec2(wx, wy), b->position);
-    }
+// This correctly handles rotated rectangles: the cached corners include its angle.
+static void resolve_rect_vs_bounds(const Body *b, Vec2 *position, Vec2 *velocity, float *angular_velocity,
+                                   const BodyTransform *xf, float left, float top, float right, float bottom) {
+    // The 4 corners of the rotated rectangle (OBB) come from the transform cache
+    const Vec2 *world_corners = xf->corners;
     
     // Check each corner against boundaries and resolve
     // Track the worst penetration for each boundary
@@ -209,11 +571,11 @@ static void resolve_rect_vs_bounds(Body *b, float left, float top, float right,
     // Apply collision response if we had a boundary collision
     if (had_collision) {
         // Apply positional correction
-        b->position = vec2_add(b->position, correction);
+        *position = vec2_add(*position, correction);
         
         // Calculate velocity at contact point
-        Vec2 r = vec2_sub(contact_point, b->position);
-        Vec2 point_velocity = vec2_add(b->velocity, vec2_scale(vec2_perp(r), b->angular_velocity));
+        Vec2 r = vec2_sub(contact_point, *position);
+        Vec2 point_velocity = vec2_add(*velocity, vec2_scale(vec2_perp(r), *angular_velocity));
         
         // Velocity component along the collision normal
         float vel_along_normal = vec2_dot(point_velocity, collision_normal);
@@ -233,121 +595,1198 @@ static void resolve_rect_vs_bounds(Body *b, float left, float top, float right,
                 Vec2 impulse = vec2_scale(collision_normal, j);
                 
                 // Apply impulse to velocity
-                b->velocity = vec2_add(b->velocity, vec2_scale(impulse, b->inv_mass));
+                *velocity = vec2_add(*velocity, vec2_scale(impulse, b->inv_mass));
                 
                 // Apply angular impulse
-                b->angular_velocity += vec2_cross(r, impulse) * b->inv_inertia;
+                *angular_velocity += vec2_cross(r, impulse) * b->inv_inertia;
             }
         }
     }
 }
 
+// 1 if `box` lies inside the bounds by more than BOUNDS_INSIDE_SLACK on every side.
+// lo = (left, top, -inf, -inf) and hi = (inf, inf, right, bottom) shifted by the slack,
+// so a single 4-wide compare against the box (min.x, min.y, max.x, max.y) tests all walls.
+static int aabb_inside_bounds(const AABB *box, const float lo[4], const float hi[4]) {
+#if defined(__SSE2__)
+    __m128 v = _mm_loadu_ps(&box->min.x);
+    __m128 inside = _mm_and_ps(_mm_cmpgt_ps(v, _mm_loadu_ps(lo)), _mm_cmplt_ps(v, _mm_loadu_ps(hi)));
+    return _mm_movemask_ps(inside) == 0xF;
+#else
+    return box->min.x > lo[0] && box->min.y > lo[1] && box->max.x < hi[2] && box->max.y < hi[3];
+#endif
+}
+
+static void resolve_body_vs_bounds(World *w, int i, const float lo[4], const float hi[4]) {
+    if (!body_active(w, i)) return;
+    const Body *b = &w->bodies[i];
+
+    if (b->shape.type == SHAPE_CIRCLE) {
+        resolve_circle_vs_bounds(b, &w->position[i], &w->velocity[i],
+                                 w->bound_left, w->bound_top, w->bound_right, w->bound_bottom);
+    } else if (b->shape.type == SHAPE_RECT) {
+        const BodyTransform *xf = world_get_transform(w, i);
+        if (aabb_inside_bounds(&xf->aabb, lo, hi)) return;
+        resolve_rect_vs_bounds(b, &w->position[i], &w->velocity[i], &w->angular_velocity[i], xf,
+                               w->bound_left, w->bound_top, w->bound_right, w->bound_bottom);
+    }
+}
+
 static void resolve_boundary_collisions(World *w) {
     if (!w->bounds_enabled) return;
-    
-    for (int i = 0; i < w->body_count; i++) {
-        Body *b = &w->bodies[i];
-        if (body_is_static(b)) continue;
-        
-        if (b->shape.type == SHAPE_CIRCLE) {
-            resolve_circle_vs_bounds(b, w->bound_left, w->bound_top, 
-                                     w->bound_right, w->bound_bottom);
-        } else if (b->shape.type == SHAPE_RECT) {
-            resolve_rect_vs_bounds(b, w->bound_left, w->bound_top,
-                                   w->bound_right, w->bound_bottom);
+
+    // Most rects are nowhere near a wall: their cached AABB rules out all four corners
+    // at once. The slack covers rounding between the AABB and the corners.
+    const float lo[4] = { w->bound_left + BOUNDS_INSIDE_SLACK, w->bound_top + BOUNDS_INSIDE_SLACK,
+                          -INFINITY, -INFINITY };
+    const float hi[4] = { INFINITY, INFINITY,
+                          w->bound_right - BOUNDS_INSIDE_SLACK, w->bound_bottom - BOUNDS_INSIDE_SLACK };
+    int i = 0;
+
+    // Most bodies of any shape are nowhere near a wall either: sweep the position and
+    // bound radius streams four bodies at a time and only look at Body for the rest.
+    // A body whose bounding circle clears every wall by the slack cannot touch one.
+#if defined(__SSE2__)
+    const __m128 inner_lo = _mm_setr_ps(lo[0], lo[1], lo[0], lo[1]);
+    const __m128 inner_hi = _mm_setr_ps(hi[2], hi[3], hi[2], hi[3]);
+    for (; i + 4 <= w->body_count; i += 4) {
+        const float *p = &w->position[i].x;
+        __m128 r = _mm_loadu_ps(&w->bound_radius[i]);
+        __m128 r01 = _mm_unpacklo_ps(r, r);
+        __m128 r23 = _mm_unpackhi_ps(r, r);
+        __m128 p01 = _mm_loadu_ps(p);
+        __m128 p23 = _mm_loadu_ps(p + 4);
+        __m128 in01 = _mm_and_ps(_mm_cmpgt_ps(_mm_sub_ps(p01, r01), inner_lo),
+                                 _mm_cmplt_ps(_mm_add_ps(p01, r01), inner_hi));
+        __m128 in23 = _mm_and_ps(_mm_cmpgt_ps(_mm_sub_ps(p23, r23), inner_lo),
+                                 _mm_cmplt_ps(_mm_add_ps(p23, r23), inner_hi));
+        int inside = _mm_movemask_ps(in01) | (_mm_movemask_ps(in23) << 4);  // Two bits per body
+        if (inside == 0xFF) continue;
+        for (int k = 0; k < 4; k++) {
+            if (((inside >> (2 * k)) & 3) != 3) resolve_body_vs_bounds(w, i + k, lo, hi);
+        }
+    }
+#endif
+    for (; i < w->body_count; i++) {
+        resolve_body_vs_bounds(w, i, lo, hi);
+    }
+}
+
+// Run the shape-specific narrowphase for bodies i and j.
+// Returns 1 and fills `col` (normal from i to j) if they collide.
+static int detect_pair(World *w, int i, int j, Collision *col) {
+    Body *a = &w->bodies[i];
+    Body *b = &w->bodies[j];
+    int collided = 0;
+
+    if (a->shape.type == SHAPE_CIRCLE && b->shape.type == SHAPE_CIRCLE) {
+        // Circle-circle collision
+        collided = collision_detect_circles(a, w->position[i], b, w->position[j], col);
+    }
+    else if (a->shape.type == SHAPE_CIRCLE && b->shape.type == SHAPE_RECT) {
+        // Circle-rect collision (circle is A, rect is B)
+        collided = collision_detect_circle_rect(a, w->position[i], b, world_get_transform(w, j), col);
+    }
+    else if (a->shape.type == SHAPE_RECT && b->shape.type == SHAPE_CIRCLE) {
+        // Rect-circle collision: call with swapped order, then negate normal
+        collided = collision_detect_circle_rect(b, w->position[j], a, world_get_transform(w, i), col);
+        if (collided) {
+            col->normal = vec2_negate(col->normal);
+        }
+    }
+    else if (a->shape.type == SHAPE_RECT && b->shape.type == SHAPE_RECT) {
+        // Rect-rect collision using SAT (axis hints are only kept for the batched pass)
+        collided = collision_detect_rects(world_get_transform(w, i), world_get_transform(w, j), NULL, col);
+    }
+
+    if (collided) {
+        col->body_a = i;
+        col->body_b = j;
+    }
+    return collided;
+}
+
+// Cache entry for the same pair and feature, or NULL if the contact point is new
+static ContactCacheEntry *contact_cache_find(World *w, int body_a, int body_b, int feature) {
+    int lo = 0;
+    int hi = w->contact_cache_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        ContactCacheEntry *e = &w->contact_cache[mid];
+        int d = (e->body_a != body_a) ? e->body_a - body_a :
+                (e->body_b != body_b) ? e->body_b - body_b :
+                e->feature - feature;
+        if (d == 0) return e;
+        if (d < 0) lo = mid + 1; else hi = mid - 1;
+    }
+    return NULL;
+}
+
+// --- Contact buffers ---
+
+// Grow a world-owned buffer to hold at least `needed` elements, doubling its capacity.
+// Returns the (possibly moved) buffer, or NULL if out of memory (old buffer left intact).
+static void *grow_buffer(void *data, int *capacity, int needed, size_t size) {
+    int new_capacity = (*capacity > 0) ? *capacity : CONTACT_BUFFER_INITIAL;
+    while (new_capacity < needed) new_capacity *= 2;
+    void *grown = realloc(data, (size_t)new_capacity * size);
+    if (grown) *capacity = new_capacity;
+    return grown;
+}
+
+// Make room for `needed` contacts. Returns -1 if out of memory (the contact is dropped).
+// Pointers into w->contacts are invalidated when the buffer grows.
+static int reserve_contacts(World *w, int needed) {
+    if (needed <= w->contact_capacity) return 0;
+    ContactManifold *grown = grow_buffer(w->contacts, &w->contact_capacity, needed, sizeof(ContactManifold));
+    if (!grown) return -1;
+    w->contacts = grown;
+    return 0;
+}
+
+static int reserve_contact_cache(World *w, int needed) {
+    if (needed <= w->contact_cache_capacity) return 0;
+    ContactCacheEntry *grown = grow_buffer(w->contact_cache, &w->contact_cache_capacity, needed,
+                                           sizeof(ContactCacheEntry));
+    if (!grown) return -1;
+    w->contact_cache = grown;
+    return 0;
+}
+
+// Solver view of body `i`: its hot state in the streams plus the Body constants the
+// solver needs. Static bodies are only read through it (see SolverBody).
+static SolverBody solver_body(World *w, int i) {
+    const Body *b = &w->bodies[i];
+    SolverBody s = { &w->position[i], &w->velocity[i], &w->angular_velocity[i],
+                     b->inv_mass, b->inv_inertia, b->restitution };
+    return s;
+}
+
+// Set up a freshly detected contact. Each point that persists from last step (same
+// feature) takes over last step's impulse, applied by contacts_warm_start.
+static void contact_begin(World *w, ContactManifold *m) {
+    world_wake_body(w, m->col.body_a);   // Touched by an awake body
+    world_wake_body(w, m->col.body_b);
+    contact_manifold_init(m, w->position[m->col.body_a], w->position[m->col.body_b]);
+
+    for (int k = 0; k < m->col.point_count; k++) {
+        ContactCacheEntry *e = contact_cache_find(w, m->col.body_a, m->col.body_b, m->col.points[k].feature);
+        if (!e || e->matched) continue;
+        m->normal_impulse[k] = e->normal_impulse * CONTACT_WARM_START;
+        e->matched = 1;
+    }
+}
+
+// Warm start contacts [first, contact_count): apply the impulses they took over at their
+// new points, so resting contacts hold their bodies from the first iteration on. Only
+// contacts detected again are warm started, so there is nothing to take back, and only
+// velocities change (the broadphase has already seen this step's poses).
+// Sequential impulse fixes each contact's bias first: bounces are judged on the
+// velocities the bodies arrived with, not on other contacts' warm starts pushing them
+// together (which would bounce a resting stack apart).
+static void contacts_warm_start(World *w, int first) {
+    if (w->solver == SOLVER_SEQUENTIAL_IMPULSE) {
+        for (int i = first; i < w->contact_count; i++) {
+            ContactManifold *m = &w->contacts[i];
+            SolverBody a = solver_body(w, m->col.body_a);
+            SolverBody b = solver_body(w, m->col.body_b);
+            contact_manifold_prepare(m, &a, &b, w->dt);
+        }
+    }
+    for (int i = first; i < w->contact_count; i++) {
+        ContactManifold *m = &w->contacts[i];
+        SolverBody a = solver_body(w, m->col.body_a);
+        SolverBody b = solver_body(w, m->col.body_b);
+        for (int k = 0; k < m->col.point_count; k++) {
+            if (m->normal_impulse[k] <= 0.0f) continue;
+            collision_apply_impulse(&a, &b, m->col.points[k].point, m->col.normal, m->normal_impulse[k]);
         }
     }
 }
 
-// Detect all body-body collisions and store in array.
-// Returns the number of collisions detected.
-static int detect_all_collisions(World *w, Collision *collisions, int max_collisions) {
+// Remember this step's accumulated impulses for the next one, one entry per contact point.
+// Impacts (contacts that bounced) are not kept: their impulse is a one-off, and warm
+// starting it would push the bodies apart before the solver could take it back.
+// Contacts are sorted by pair; features of one pair are few, so insertion sort them.
+static void contact_cache_store(World *w) {
+    int limit = MAX_CONTACT_POINTS * w->contact_count;
+    if (reserve_contact_cache(w, limit) != 0) limit = w->contact_cache_capacity;  // Out of memory: keep what fits
+
     int count = 0;
-    
-    //TODO: optimize the collision detection algorithm
-    for (int i = 0; i < w->body_count && count < max_collisions; i++) {
-        for (int j = i + 1; j < w->body_count && count < max_collisions; j++) {
-            Body *a = &w->bodies[i];
-            Body *b = &w->bodies[j];
-            
-            Collision col;
-            int collided = 0;
-            
-            if (a->shape.type == SHAPE_CIRCLE && b->shape.type == SHAPE_CIRCLE) {
-                // Circle-circle collision
-                collided = collision_detect_circles(a, b, &col);
-            } 
-            else if (a->shape.type == SHAPE_CIRCLE && b->shape.type == SHAPE_RECT) {
-                // Circle-rect collision (circle is A, rect is B)
-                collided = collision_detect_circle_rect(a, b, &col);
+    for (int i = 0; i < w->contact_count; i++) {
+        const ContactManifold *m = &w->contacts[i];
+        for (int p = 0; p < m->col.point_count && count < limit; p++) {
+            if (m->normal_impulse[p] <= 0.0f || m->impact[p]) continue;
+
+            ContactCacheEntry e;
+            e.body_a = m->col.body_a;
+            e.body_b = m->col.body_b;
+            e.feature = m->col.points[p].feature;
+            e.normal_impulse = m->normal_impulse[p];
+            e.matched = 0;
+
+            int k = count;
+            while (k > 0 && w->contact_cache[k - 1].body_a == e.body_a &&
+                   w->contact_cache[k - 1].body_b == e.body_b && w->contact_cache[k - 1].feature > e.feature) {
+                w->contact_cache[k] = w->contact_cache[k - 1];
+                k--;
             }
-            else if (a->shape.type == SHAPE_RECT && b->shape.type == SHAPE_CIRCLE) {
-                // Rect-circle collision: call with swapped order, then negate normal
-                collided = collision_detect_circle_rect(b, a, &col);
-                if (collided) {
-                    col.normal = vec2_negate(col.normal);
+            w->contact_cache[k] = e;
+            count++;
+        }
+    }
+    w->contact_cache_count = count;
+}
+
+// --- Batched narrowphase ---
+
+static int reserve_batches(World *w, int needed) {
+    NarrowphaseBatches *nb = &w->batches;
+    if (needed <= nb->capacity) return 0;
+    int capacity = (nb->capacity > 0) ? nb->capacity : CONTACT_BUFFER_INITIAL;
+    while (capacity < needed) capacity *= 2;
+
+    // Each buffer keeps its old size if its own realloc fails
+    int *slot = realloc(nb->slot, (size_t)capacity * sizeof(int));
+    if (slot) nb->slot = slot;
+    int *body_a = realloc(nb->body_a, (size_t)capacity * sizeof(int));
+    if (body_a) nb->body_a = body_a;
+    int *body_b = realloc(nb->body_b, (size_t)capacity * sizeof(int));
+    if (body_b) nb->body_b = body_b;
+    Collision *results = realloc(nb->results, (size_t)capacity * sizeof(Collision));
+    if (results) nb->results = results;
+    int *sat_axis = realloc(nb->sat_axis, (size_t)capacity * sizeof(int));
+    if (sat_axis) nb->sat_axis = sat_axis;
+    if (!slot || !body_a || !body_b || !results || !sat_axis) return -1;
+
+    nb->capacity = capacity;
+    return 0;
+}
+
+// Axis hints for the rect-rect bin from last step's SAT axes. The bin keeps pair order,
+// so both lists are sorted by pair and one merge pass finds every hint.
+static void sat_cache_load(World *w) {
+    NarrowphaseBatches *nb = &w->batches;
+    const SatAxisCacheEntry *cache = w->sat_cache;
+    int s = nb->start[SHAPE_PAIR_RECT_RECT];
+    int cursor = 0;
+    for (int n = s; n < s + nb->count[SHAPE_PAIR_RECT_RECT]; n++) {
+        int i = nb->body_a[n];
+        int j = nb->body_b[n];
+        while (cursor < w->sat_cache_count &&
+               (cache[cursor].body_a < i || (cache[cursor].body_a == i && cache[cursor].body_b < j))) {
+            cursor++;
+        }
+        int found = (cursor < w->sat_cache_count && cache[cursor].body_a == i && cache[cursor].body_b == j);
+        nb->sat_axis[n] = found ? cache[cursor].axis : SAT_AXIS_NONE;
+    }
+}
+
+// Keep the rect-rect bin's SAT axes for the next step (pairs not tested this step are dropped)
+static void sat_cache_store(World *w) {
+    NarrowphaseBatches *nb = &w->batches;
+    int count = nb->count[SHAPE_PAIR_RECT_RECT];
+    if (count > w->sat_cache_capacity) {
+        SatAxisCacheEntry *grown = grow_buffer(w->sat_cache, &w->sat_cache_capacity, count,
+                                               sizeof(SatAxisCacheEntry));
+        if (!grown) {
+            w->sat_cache_count = 0;  // Out of memory: no hints next step
+            return;
+        }
+        w->sat_cache = grown;
+    }
+
+    int s = nb->start[SHAPE_PAIR_RECT_RECT];
+    for (int n = 0; n < count; n++) {
+        w->sat_cache[n].body_a = nb->body_a[s + n];
+        w->sat_cache[n].body_b = nb->body_b[s + n];
+        w->sat_cache[n].axis = nb->sat_axis[s + n];
+    }
+    w->sat_cache_count = count;
+}
+
+static ShapePair shape_pair(const Body *a, const Body *b) {
+    if (a->shape.type != b->shape.type) return SHAPE_PAIR_CIRCLE_RECT;
+    return (a->shape.type == SHAPE_CIRCLE) ? SHAPE_PAIR_CIRCLE_CIRCLE : SHAPE_PAIR_RECT_RECT;
+}
+
+// Tasks needed for bin `t` at NARROWPHASE_TASK_PAIRS slots each
+static int bin_tasks(const NarrowphaseBatches *nb, int t) {
+    return (nb->count[t] + NARROWPHASE_TASK_PAIRS - 1) / NARROWPHASE_TASK_PAIRS;
+}
+
+// Narrowphase task: one chunk of one bin through its kernel. Kernels only read bodies
+// and transforms and write their own slots, so chunks can run on any thread. Chunks
+// start at multiples of NARROWPHASE_TASK_PAIRS, so the SIMD kernels see the same
+// 8-pair groups whatever the thread count.
+static void detect_batch_task(void *context, int task, int thread) {
+    (void)thread;
+    World *w = (World *)context;
+    NarrowphaseBatches *nb = &w->batches;
+    int t = 0;
+    while (task >= bin_tasks(nb, t)) task -= bin_tasks(nb, t++);
+    int s = nb->start[t] + task * NARROWPHASE_TASK_PAIRS;
+    int count = nb->start[t] + nb->count[t] - s;
+    if (count > NARROWPHASE_TASK_PAIRS) count = NARROWPHASE_TASK_PAIRS;
+
+    if (t == SHAPE_PAIR_CIRCLE_CIRCLE) {
+        collision_detect_circles_batch(w->bodies, w->position, nb->body_a + s, nb->body_b + s, count, nb->results + s);
+    } else if (t == SHAPE_PAIR_CIRCLE_RECT) {
+        for (int n = s; n < s + count; n++) {
+            int c = nb->body_a[n];
+            int r = nb->body_b[n];
+            Collision *col = &nb->results[n];
+            col->point_count = 0;
+            if (!collision_detect_circle_rect(&w->bodies[c], w->position[c], &w->bodies[r], &w->transforms[r], col)) continue;
+            if (c > r) {
+                // Pair is (rect, circle): flip back to the pair's order, as detect_pair does
+                col->normal = vec2_negate(col->normal);
+                col->body_a = r;
+                col->body_b = c;
+            } else {
+                col->body_a = c;
+                col->body_b = r;
+            }
+        }
+    } else {
+        collision_detect_rects_batch(w->transforms, nb->body_a + s, nb->body_b + s,
+                                     nb->sat_axis + s, count, nb->results + s);
+    }
+}
+
+// Bin this step's candidate pairs by shape combination (pairs with both bodies
+// inactive are skipped), then run each bin through its kernel, in chunks spread over
+// the world's threads. Bins keep pair order, and circle-rect pairs are stored circle
+// first so their kernel needs no swap.
+static void detect_batches(World *w) {
+    NarrowphaseBatches *nb = &w->batches;
+
+    for (int t = 0; t < SHAPE_PAIR_COUNT; t++) nb->count[t] = 0;
+    for (int k = 0; k < w->pair_count; k++) {
+        int i = w->pairs[k].a;
+        int j = w->pairs[k].b;
+        if (!body_active(w, i) && !body_active(w, j)) {
+            nb->slot[k] = -1;
+            continue;
+        }
+        nb->slot[k] = shape_pair(&w->bodies[i], &w->bodies[j]);  // Bin for now, slot below
+        nb->count[nb->slot[k]]++;
+    }
+    int next[SHAPE_PAIR_COUNT];
+    for (int t = 0, start = 0; t < SHAPE_PAIR_COUNT; t++) {
+        nb->start[t] = next[t] = start;
+        start += nb->count[t];
+    }
+    for (int k = 0; k < w->pair_count; k++) {
+        if (nb->slot[k] < 0) continue;
+        int slot = next[nb->slot[k]]++;
+        int i = w->pairs[k].a;
+        int j = w->pairs[k].b;
+        int swap = (nb->slot[k] == SHAPE_PAIR_CIRCLE_RECT && w->bodies[i].shape.type == SHAPE_RECT);
+        nb->body_a[slot] = swap ? j : i;
+        nb->body_b[slot] = swap ? i : j;
+        nb->slot[k] = slot;
+    }
+
+    // The kernels read transforms directly (world_get_transform updates them, which
+    // tasks must not do): bring the rect bodies' up to date first
+    int s = nb->start[SHAPE_PAIR_CIRCLE_RECT];
+    for (int n = s; n < s + nb->count[SHAPE_PAIR_CIRCLE_RECT] + nb->count[SHAPE_PAIR_RECT_RECT]; n++) {
+        world_get_transform(w, nb->body_a[n]);
+        world_get_transform(w, nb->body_b[n]);
+    }
+    sat_cache_load(w);
+
+    int tasks = 0;
+    for (int t = 0; t < SHAPE_PAIR_COUNT; t++) tasks += bin_tasks(nb, t);
+    task_pool_run(w->tasks, detect_batch_task, w, tasks);
+
+    sat_cache_store(w);
+}
+
+// Full narrowphase over this step's candidate pairs into w->contacts.
+// Pairs are visited in (a, b) order, so contacts come out sorted.
+static void detect_contacts(World *w) {
+    int count = 0;
+
+    if (w->broadphase == BROADPHASE_BRUTE_FORCE) {
+        for (int i = 0; i < w->body_count; i++) {
+            int i_active = body_active(w, i);
+            for (int j = i + 1; j < w->body_count; j++) {
+                if (!i_active && !body_active(w, j)) continue;  // Static or asleep on both sides
+                if (!body_should_collide(&w->bodies[i], &w->bodies[j])) continue;  // Layers/groups
+                if (reserve_contacts(w, count + 1) != 0) break;
+                ContactManifold *m = &w->contacts[count];
+                if (detect_pair(w, i, j, &m->col)) {
+                    contact_begin(w, m);
+                    count++;
                 }
             }
-            else if (a->shape.type == SHAPE_RECT && b->shape.type == SHAPE_RECT) {
-                // Rect-rect collision using SAT
-                collided = collision_detect_rects(a, b, &col);
+        }
+    } else {
+        // Detection only reads poses and contact_begin only changes velocities, so the
+        // whole list can be detected in batches first (on all threads) and begun in pair
+        // order after: this serial pass merges the threads' results deterministically
+        NarrowphaseBatches *nb = &w->batches;
+        int batched = (reserve_batches(w, w->pair_count) == 0);
+        if (batched) detect_batches(w);
+
+        for (int k = 0; k < w->pair_count; k++) {
+            int i = w->pairs[k].a;
+            int j = w->pairs[k].b;
+            if (!body_active(w, i) && !body_active(w, j)) continue;
+            if (reserve_contacts(w, count + 1) != 0) break;
+            ContactManifold *m = &w->contacts[count];
+            int slot = batched ? nb->slot[k] : -1;
+            if (slot >= 0) {
+                if (nb->results[slot].point_count == 0) continue;
+                m->col = nb->results[slot];
+            } else if (!detect_pair(w, i, j, &m->col)) {
+                continue;  // Out of memory for batches, or woken by an earlier contact
             }
-            
-            if (collided) {
-                col.body_a = i;
-                col.body_b = j;
-                collisions[count++] = col;
+            contact_begin(w, m);
+            count++;
+        }
+    }
+
+    w->contact_count = count;
+    w->colors.dirty = 1;
+    w->islands.dirty = 1;
+    for (int i = 0; i < w->body_count; i++) {
+        w->solver_positions[i] = w->position[i];
+    }
+    contacts_warm_start(w, 0);
+}
+
+static int compare_contacts(const void *lhs, const void *rhs) {
+    const Collision *p = &((const ContactManifold *)lhs)->col;
+    const Collision *q = &((const ContactManifold *)rhs)->col;
+    if (p->body_a != q->body_a) return p->body_a - q->body_a;
+    return p->body_b - q->body_b;
+}
+
+// Try one candidate pair in the incremental pass. `cursor` walks the sorted contact
+// list in step with the (sorted) candidate pairs to skip pairs that already have one.
+static void detect_new_pair(World *w, int i, int j, int existing, int *cursor) {
+    if (!w->body_moved[i] && !w->body_moved[j]) return;  // Same poses as last pass: still apart
+
+    const ContactManifold *c = w->contacts;
+    while (*cursor < existing &&
+           (c[*cursor].col.body_a < i || (c[*cursor].col.body_a == i && c[*cursor].col.body_b < j))) {
+        (*cursor)++;
+    }
+    if (*cursor < existing && c[*cursor].col.body_a == i && c[*cursor].col.body_b == j) return;
+
+    if (reserve_contacts(w, w->contact_count + 1) != 0) return;
+    ContactManifold *m = &w->contacts[w->contact_count];
+    if (detect_pair(w, i, j, &m->col)) {
+        contact_begin(w, m);
+        w->contact_count++;
+    }
+}
+
+// Cheap pass between solver iterations: only candidate pairs without a contact and
+// with at least one body moved by the last iteration go through the narrowphase.
+static void detect_new_contacts(World *w) {
+    for (int i = 0; i < w->body_count; i++) {
+        Vec2 p = w->position[i];
+        w->body_moved[i] = (p.x != w->solver_positions[i].x || p.y != w->solver_positions[i].y);
+        w->solver_positions[i] = p;
+    }
+
+    int existing = w->contact_count;
+    int cursor = 0;
+    if (w->broadphase == BROADPHASE_BRUTE_FORCE) {
+        for (int i = 0; i < w->body_count; i++) {
+            int i_active = body_active(w, i);
+            for (int j = i + 1; j < w->body_count; j++) {
+                if (!i_active && !body_active(w, j)) continue;
+                if (!body_should_collide(&w->bodies[i], &w->bodies[j])) continue;
+                detect_new_pair(w, i, j, existing, &cursor);
             }
         }
+    } else {
+        for (int k = 0; k < w->pair_count; k++) {
+            detect_new_pair(w, w->pairs[k].a, w->pairs[k].b, existing, &cursor);
+        }
     }
-    
-    return count;
+
+    // Keep the solver order by body pair
+    if (w->contact_count > existing) {
+        contacts_warm_start(w, existing);
+        qsort(w->contacts, (size_t)w->contact_count, sizeof(ContactManifold), compare_contacts);
+        w->colors.dirty = 1;
+        w->islands.dirty = 1;
+    }
+}
+
+// --- Contact solving ---
+
+// One solver pass over contact `m`. Contacts separated since detection are skipped
+// unless they still hold impulse they may need to take back.
+static void solve_contact(World *w, ContactManifold *m, SolverPass *pass) {
+    if (m->col.penetration <= 0.0f && m->normal_impulse[0] <= 0.0f &&
+        m->normal_impulse[1] <= 0.0f) return;  // Separated since detection
+    SolverBody view_a = solver_body(w, m->col.body_a);
+    SolverBody view_b = solver_body(w, m->col.body_b);
+    const SolverBody *a = &view_a;
+    const SolverBody *b = &view_b;
+    if (w->solver == SOLVER_SEQUENTIAL_IMPULSE) {
+        // Penetration within the slop is left alone on purpose
+        pass->penetration_error = fmaxf(pass->penetration_error, m->col.penetration - SI_LINEAR_SLOP);
+        pass->velocity_error = fmaxf(pass->velocity_error, collision_solve_contact(a, b, m));
+    } else {
+        pass->penetration_error = fmaxf(pass->penetration_error, m->col.penetration);
+        pass->velocity_error = fmaxf(pass->velocity_error, collision_resolve(a, b, m));
+    }
+    pass->contacts++;
+}
+
+// Make room for `needed` contacts in the coloring buffers. Returns -1 if out of memory.
+static int reserve_colors(World *w, int needed) {
+    ContactColors *cc = &w->colors;
+    if (needed <= cc->capacity) return 0;
+    int capacity = (cc->capacity > 0) ? cc->capacity : CONTACT_BUFFER_INITIAL;
+    while (capacity < needed) capacity *= 2;
+
+    int failed = 0;
+    RESIZE_ARRAY(cc->color, capacity, failed);
+    RESIZE_ARRAY(cc->order, capacity, failed);
+    if (failed) return -1;
+    cc->capacity = capacity;
+    return 0;
+}
+
+// Greedy coloring in contact order: each contact takes the lowest color that moves
+// neither of its dynamic bodies yet, so early colors are the largest. Returns -1 if
+// out of memory (the contacts are then solved in plain pair order).
+static int color_contacts(World *w) {
+    ContactColors *cc = &w->colors;
+    if (reserve_colors(w, w->contact_count) != 0) return -1;
+
+    for (int i = 0; i < w->contact_count; i++) {
+        cc->body_colors[w->contacts[i].col.body_a] = 0;
+        cc->body_colors[w->contacts[i].col.body_b] = 0;
+    }
+
+    int count[SOLVER_COLORS + 1] = {0};
+    for (int i = 0; i < w->contact_count; i++) {
+        int a = w->contacts[i].col.body_a;
+        int b = w->contacts[i].col.body_b;
+        int a_dynamic = !body_is_static(&w->bodies[a]);
+        int b_dynamic = !body_is_static(&w->bodies[b]);
+        unsigned int used = (a_dynamic ? cc->body_colors[a] : 0u) | (b_dynamic ? cc->body_colors[b] : 0u);
+
+        int color = (used == ~0u) ? SOLVER_COLORS : __builtin_ctz(~used);
+        if (color < SOLVER_COLORS) {
+            if (a_dynamic) cc->body_colors[a] |= 1u << color;
+            if (b_dynamic) cc->body_colors[b] |= 1u << color;
+        }
+        cc->color[i] = color;
+        count[color]++;
+    }
+
+    // Counting sort by color; contact order is kept within each color
+    int next[SOLVER_COLORS + 1];
+    cc->color_count = 0;
+    for (int c = 0, start = 0; c <= SOLVER_COLORS; c++) {
+        cc->start[c] = next[c] = start;
+        start += count[c];
+        if (c < SOLVER_COLORS && count[c] > 0) cc->color_count = c + 1;
+    }
+    cc->start[SOLVER_COLORS + 1] = w->contact_count;
+    for (int i = 0; i < w->contact_count; i++) {
+        cc->order[next[cc->color[i]]++] = i;
+    }
+    cc->dirty = 0;
+    return 0;
+}
+
+// The contacts of one color, handed to solve_color_task
+typedef struct {
+    World *w;
+    int first;            // Into w->colors.order
+    int count;
+    SolverPass *passes;   // One per thread
+} ColorRange;
+
+// Solver task: one chunk of a color. Its contacts share no dynamic body with any other
+// contact of the color, so chunks can run on any thread in any order. Static bodies are
+// shared between chunks, but the solver only reads them.
+static void solve_color_task(void *context, int task, int thread) {
+    const ColorRange *range = (const ColorRange *)context;
+    World *w = range->w;
+    int first = range->first + task * SOLVER_TASK_CONTACTS;
+    int last = range->first + range->count;
+    if (last > first + SOLVER_TASK_CONTACTS) last = first + SOLVER_TASK_CONTACTS;
+
+    for (int n = first; n < last; n++) {
+        solve_contact(w, &w->contacts[w->colors.order[n]], &range->passes[thread]);
+    }
+}
+
+// Max and sum combine the threads' results exactly, whichever thread solved what
+static void combine_passes(SolverPass *pass, const SolverPass *passes, int threads) {
+    for (int t = 0; t < threads; t++) {
+        pass->penetration_error = fmaxf(pass->penetration_error, passes[t].penetration_error);
+        pass->velocity_error = fmaxf(pass->velocity_error, passes[t].velocity_error);
+        pass->contacts += passes[t].contacts;
+    }
+}
+
+// Color by color, each spread over the world's threads. Odd iterations walk the
+// colors backwards: a one-way sweep would only carry a push two contacts further up a
+// stack per iteration (colors alternate along it), and bouncy stacks never settle.
+static void solve_colors(World *w, int iteration, SolverPass *pass) {
+    ContactColors *cc = &w->colors;
+    int threads = task_pool_thread_count(w->tasks);
+    SolverPass single;
+    SolverPass *passes = w->tasks ? w->thread_passes : &single;
+    memset(passes, 0, (size_t)threads * sizeof(SolverPass));
+    for (int k = 0; k < cc->color_count; k++) {
+        int c = (iteration & 1) ? cc->color_count - 1 - k : k;
+        ColorRange range = { w, cc->start[c], cc->start[c + 1] - cc->start[c], passes };
+        int tasks = (range.count + SOLVER_TASK_CONTACTS - 1) / SOLVER_TASK_CONTACTS;
+        task_pool_run(w->tasks, solve_color_task, &range, tasks);
+    }
+    combine_passes(pass, passes, threads);
+
+    // Contacts that found no free color, serially in pair order
+    for (int n = cc->start[SOLVER_COLORS]; n < cc->start[SOLVER_COLORS + 1]; n++) {
+        solve_contact(w, &w->contacts[cc->order[n]], pass);
+    }
+    w->stats.solver_colors = cc->color_count;
+}
+
+// Make room for `needed` contacts in the island buffers. Returns -1 if out of memory.
+static int reserve_islands(World *w, int needed) {
+    ContactIslands *ci = &w->islands;
+    if (needed <= ci->capacity) return 0;
+    int capacity = (ci->capacity > 0) ? ci->capacity : CONTACT_BUFFER_INITIAL;
+    while (capacity < needed) capacity *= 2;
+
+    int failed = 0;
+    RESIZE_ARRAY(ci->island, capacity, failed);
+    RESIZE_ARRAY(ci->order, capacity, failed);
+    RESIZE_ARRAY(ci->islands, capacity, failed);
+    if (failed) return -1;
+    ci->capacity = capacity;
+    return 0;
+}
+
+static int island_find(int *parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];  // Path halving
+        i = parent[i];
+    }
+    return i;
+}
+
+// Most contacts first, so the big islands start before the small ones fill in around
+// them; ties keep contact order
+static int compare_islands(const void *lhs, const void *rhs) {
+    const ContactIsland *p = (const ContactIsland *)lhs;
+    const ContactIsland *q = (const ContactIsland *)rhs;
+    if (p->count != q->count) return q->count - p->count;
+    return p->first - q->first;
+}
+
+// Union-find over the contacts' dynamic bodies (static bodies link nothing), then
+// group contact indices by island. Returns -1 if out of memory (the contacts are then
+// solved in plain pair order).
+static int build_islands(World *w) {
+    ContactIslands *ci = &w->islands;
+    if (reserve_islands(w, w->contact_count) != 0) return -1;
+
+    // update_sleep rebuilds its own forest after the solver, so its scratch is free here
+    int *parent = w->island_parent;
+    for (int i = 0; i < w->contact_count; i++) {
+        int a = w->contacts[i].col.body_a;
+        int b = w->contacts[i].col.body_b;
+        parent[a] = a;
+        parent[b] = b;
+        ci->body_island[a] = -1;
+        ci->body_island[b] = -1;
+    }
+    for (int i = 0; i < w->contact_count; i++) {
+        int a = w->contacts[i].col.body_a;
+        int b = w->contacts[i].col.body_b;
+        if (body_is_static(&w->bodies[a]) || body_is_static(&w->bodies[b])) continue;
+        int ra = island_find(parent, a);
+        int rb = island_find(parent, b);
+        if (ra != rb) parent[rb] = ra;
+    }
+
+    // Number islands in order of their first contact, then counting sort the contacts
+    ci->island_count = 0;
+    for (int i = 0; i < w->contact_count; i++) {
+        int a = w->contacts[i].col.body_a;
+        int root = island_find(parent, body_is_static(&w->bodies[a]) ? w->contacts[i].col.body_b : a);
+        if (ci->body_island[root] < 0) {
+            ContactIsland *island = &ci->islands[ci->island_count];
+            island->count = 0;
+            island->ticks = 0;
+            ci->body_island[root] = ci->island_count++;
+        }
+        ci->island[i] = ci->body_island[root];
+        ci->islands[ci->island[i]].count++;
+    }
+    for (int k = 0, first = 0; k < ci->island_count; k++) {
+        ci->islands[k].first = first;
+        first += ci->islands[k].count;
+    }
+    for (int i = 0; i < w->contact_count; i++) {
+        ci->order[ci->islands[ci->island[i]].first++] = i;
+    }
+    for (int k = 0; k < ci->island_count; k++) {
+        ci->islands[k].first -= ci->islands[k].count;  // Back from one past the end
+    }
+
+    if (ci->island_count > 1) {
+        qsort(ci->islands, (size_t)ci->island_count, sizeof(ContactIsland), compare_islands);
+    }
+    ci->dirty = 0;
+    return 0;
+}
+
+// Solver task: one whole island in contact order. Islands share no dynamic body, so
+// they can run on any thread in any order and each body sees exactly the updates of
+// the plain pair-order pass. Static bodies are only read, as in solve_color_task.
+static void solve_island_task(void *context, int task, int thread) {
+    World *w = (World *)context;
+    ContactIsland *island = &w->islands.islands[task];
+    Uint64 start = w->profiling ? SDL_GetPerformanceCounter() : 0;
+    for (int n = island->first; n < island->first + island->count; n++) {
+        solve_contact(w, &w->contacts[w->islands.order[n]], &w->thread_passes[thread]);
+    }
+    if (w->profiling) {
+        Uint64 ticks = SDL_GetPerformanceCounter() - start;
+        island->ticks += ticks;               // One task per island per iteration
+        w->thread_ticks[thread] += ticks;     // Own slot only
+    }
+}
+
+// Every island as one task on the world's threads, largest first; idle threads steal
+// from busy ones (see task.h)
+static void solve_islands(World *w, SolverPass *pass) {
+    int threads = task_pool_thread_count(w->tasks);
+    memset(w->thread_passes, 0, (size_t)threads * sizeof(SolverPass));
+    task_pool_run(w->tasks, solve_island_task, w, w->islands.island_count);
+    combine_passes(pass, w->thread_passes, threads);
+    w->stats.solver_islands = w->islands.island_count;
+}
+
+// One solver iteration over every contact
+static void solve_contacts(World *w, int iteration, SolverPass *pass) {
+    w->stats.solver_colors = 0;
+    w->stats.solver_islands = 0;
+    if (w->solver_coloring && (!w->colors.dirty || color_contacts(w) == 0)) {
+        solve_colors(w, iteration, pass);
+    } else if (w->tasks && (!w->islands.dirty || build_islands(w) == 0)) {
+        solve_islands(w, pass);
+    } else {
+        // Plain Gauss-Seidel in pair order
+        for (int i = 0; i < w->contact_count; i++) {
+            solve_contact(w, &w->contacts[i], pass);
+        }
+    }
+}
+
+// --- Sleeping ---
+// Bodies that stay slow for SLEEP_TIME stop being simulated, a whole island (bodies
+// linked by contacts) at a time. Sleepers keep their pose and zero velocity until an
+// awake body touches them or something outside the step moves them.
+
+// Wake sleepers whose pose or velocity was changed from outside since they fell asleep
+// (e.g. the actuator being posed)
+static void wake_disturbed_bodies(World *w) {
+    if (w->sleeper_count == 0) return;
+    for (int i = 0; i < w->body_count; i++) {
+        if (!w->asleep[i]) continue;
+        Vec2 p = w->position[i];
+        Vec2 v = w->velocity[i];
+        if (p.x != w->sleep_position[i].x || p.y != w->sleep_position[i].y ||
+            w->angle[i] != w->sleep_angle[i] || v.x != 0.0f || v.y != 0.0f ||
+            w->angular_velocity[i] != 0.0f) {
+            world_wake_body(w, i);
+        }
+    }
+}
+
+static int any_body_awake(const World *w) {
+    for (int i = 0; i < w->body_count; i++) {
+        if (body_active(w, i)) return 1;
+    }
+    return 0;
+}
+
+static void wake_if_touching(World *w, int i, int j) {
+    if (w->asleep[i] == w->asleep[j]) return;  // Nothing to wake, or both asleep
+    if (!body_active(w, i) && !body_active(w, j)) return;  // Sleeper next to a static
+    if (aabb_overlap(&world_get_transform(w, i)->aabb, &world_get_transform(w, j)->aabb)) {
+        world_wake_body(w, w->asleep[i] ? i : j);
+    }
+}
+
+// Wake islands an awake body is about to touch, before the narrowphase, so the woken
+// bodies get their contacts with each other this step too
+static void wake_touched_islands(World *w) {
+    if (!w->sleep_enabled || w->sleeper_count == 0) return;  // Nobody to wake
+    if (w->broadphase == BROADPHASE_BRUTE_FORCE) {
+        for (int i = 0; i < w->body_count; i++) {
+            for (int j = i + 1; j < w->body_count; j++) {
+                if (!body_should_collide(&w->bodies[i], &w->bodies[j])) continue;
+                wake_if_touching(w, i, j);
+            }
+        }
+    } else {
+        for (int k = 0; k < w->pair_count; k++) {
+            wake_if_touching(w, w->pairs[k].a, w->pairs[k].b);
+        }
+    }
+}
+
+// Build islands from this step's contacts (static bodies do not link them), advance
+// each awake body's sleep timer, and put islands whose every body is due to sleep.
+// With sleeping and profiling both off it only counts the awake bodies.
+static void update_sleep(World *w) {
+    int *parent = w->island_parent;
+    float *island_rest = w->island_rest;
+    int awake = 0;
+    int islands = 0;
+
+    // Nothing can fall asleep and nobody reads the island count: skip the union-find
+    if (!w->sleep_enabled && !w->profiling) {
+        for (int i = 0; i < w->body_count; i++) {
+            if (body_active(w, i)) awake++;
+        }
+        w->stats.awake_bodies = awake;
+        w->stats.islands = 0;
+        return;
+    }
+
+    for (int i = 0; i < w->body_count; i++) {
+        parent[i] = i;
+        island_rest[i] = SLEEP_TIME;
+    }
+    for (int i = 0; i < w->contact_count; i++) {
+        int a = w->contacts[i].col.body_a;
+        int b = w->contacts[i].col.body_b;
+        if (!body_active(w, a) || !body_active(w, b)) continue;
+        int ra = island_find(parent, a);
+        int rb = island_find(parent, b);
+        if (ra != rb) parent[rb] = ra;
+    }
+
+    for (int i = 0; i < w->body_count; i++) {
+        if (!body_active(w, i)) continue;
+        int slow = vec2_len_sq(w->velocity[i]) < SLEEP_LINEAR_VELOCITY * SLEEP_LINEAR_VELOCITY &&
+                   fabsf(w->angular_velocity[i]) < SLEEP_ANGULAR_VELOCITY;
+        w->sleep_time[i] = slow ? w->sleep_time[i] + w->dt : 0.0f;
+
+        int root = island_find(parent, i);
+        if (root == i) islands++;
+        island_rest[root] = fminf(island_rest[root], w->sleep_time[i]);
+        awake++;
+    }
+
+    if (w->sleep_enabled) {
+        for (int i = 0; i < w->body_count; i++) {
+            if (!body_active(w, i)) continue;
+            int root = island_find(parent, i);
+            if (island_rest[root] < SLEEP_TIME) continue;
+
+            w->velocity[i] = VEC2_ZERO;
+            w->angular_velocity[i] = 0.0f;
+            w->asleep[i] = 1;
+            w->sleeper_count++;
+            w->moving[i] = 0;
+            w->sleep_next[i] = i;   // Linked into its island's ring below
+            w->sleep_position[i] = w->position[i];
+            w->sleep_angle[i] = w->angle[i];
+            awake--;
+        }
+
+        // Ring each island that just fell asleep through its root. Earlier sleepers took
+        // no part in this step's union-find, so they are their own roots and keep their rings
+        for (int i = 0; i < w->body_count; i++) {
+            if (!w->asleep[i]) continue;
+            int root = island_find(parent, i);
+            if (root == i) continue;
+            w->sleep_next[i] = w->sleep_next[root];
+            w->sleep_next[root] = i;
+        }
+    }
+
+    w->stats.awake_bodies = awake;
+    w->stats.islands = islands;
+}
+
+// --- Body reordering ---
+// Bodies stay in the order they were added, so neighbours in space end up scattered
+// in memory. Sorting the dynamic ones along a Z-order curve keeps each neighbourhood
+// within a few cache lines for the broadphase, narrowphase and solver loops.
+
+// Spread the low 16 bits of v over the even bits
+static uint32_t morton_spread(uint32_t v) {
+    v &= 0xffffu;
+    v = (v | (v << 8)) & 0x00ff00ffu;
+    v = (v | (v << 4)) & 0x0f0f0f0fu;
+    v = (v | (v << 2)) & 0x33333333u;
+    v = (v | (v << 1)) & 0x55555555u;
+    return v;
+}
+
+static int compare_morton(const void *lhs, const void *rhs) {
+    const MortonKey *p = (const MortonKey *)lhs;
+    const MortonKey *q = (const MortonKey *)rhs;
+    if (p->code != q->code) return (p->code < q->code) ? -1 : 1;
+    return p->index - q->index;   // Same cell: keep the current order
+}
+
+static int compare_cache_entries(const void *lhs, const void *rhs) {
+    const ContactCacheEntry *p = (const ContactCacheEntry *)lhs;
+    const ContactCacheEntry *q = (const ContactCacheEntry *)rhs;
+    if (p->body_a != q->body_a) return p->body_a - q->body_a;
+    if (p->body_b != q->body_b) return p->body_b - q->body_b;
+    return p->feature - q->feature;
+}
+
+static int compare_sat_entries(const void *lhs, const void *rhs) {
+    const SatAxisCacheEntry *p = (const SatAxisCacheEntry *)lhs;
+    const SatAxisCacheEntry *q = (const SatAxisCacheEntry *)rhs;
+    if (p->body_a != q->body_a) return p->body_a - q->body_a;
+    return p->body_b - q->body_b;
+}
+
+// data[i] = old data[from[i]] for the first `count` elements of `size` bytes
+static void permute(void *data, size_t size, const int *from, int count, void *scratch) {
+    memcpy(scratch, data, (size_t)count * size);
+    for (int i = 0; i < count; i++) {
+        memcpy((char *)data + (size_t)i * size, (const char *)scratch + (size_t)from[i] * size, size);
+    }
+}
+
+// Move the cached pairs to the new indices (to[old] = new) and sort them again.
+// Contact features and normals are relative to body A, so contacts whose pair order
+// flips are dropped and start cold. SAT axes just trade A's axes for B's.
+static void remap_caches(World *w, const int *to) {
+    int count = 0;
+    for (int i = 0; i < w->contact_cache_count; i++) {
+        ContactCacheEntry e = w->contact_cache[i];
+        e.body_a = to[e.body_a];
+        e.body_b = to[e.body_b];
+        if (e.body_a > e.body_b) continue;
+        w->contact_cache[count++] = e;
+    }
+    w->contact_cache_count = count;
+    if (count > 1) qsort(w->contact_cache, (size_t)count, sizeof(ContactCacheEntry), compare_cache_entries);
+
+    for (int i = 0; i < w->sat_cache_count; i++) {
+        SatAxisCacheEntry *e = &w->sat_cache[i];
+        int a = to[e->body_a];
+        int b = to[e->body_b];
+        e->body_a = (a < b) ? a : b;
+        e->body_b = (a < b) ? b : a;
+        if (a > b) e->axis ^= 2;   // Axes 0-1 <-> 2-3, touching flag kept
+    }
+    if (w->sat_cache_count > 1) {
+        qsort(w->sat_cache, (size_t)w->sat_cache_count, sizeof(SatAxisCacheEntry), compare_sat_entries);
+    }
+}
+
+int world_reorder_bodies(World *w) {
+    int n = w->body_count;
+    w->steps_since_reorder = 0;
+    if (n < 2) return 0;
+
+    // Scratch grows with the other per-body arrays: a reorder never allocates
+    MortonKey *keys = w->reorder_keys;
+    int *from = w->reorder_from;
+    int *to = w->reorder_to;
+    BodySlot *scratch = w->reorder_slots;
+
+    // Square grid over the dynamic bodies' bounding box
+    Vec2 lo = vec2(INFINITY, INFINITY);
+    Vec2 hi = vec2(-INFINITY, -INFINITY);
+    for (int i = 0; i < n; i++) {
+        if (body_is_static(&w->bodies[i])) continue;
+        Vec2 p = w->position[i];
+        lo = vec2(fminf(lo.x, p.x), fminf(lo.y, p.y));
+        hi = vec2(fmaxf(hi.x, p.x), fmaxf(hi.y, p.y));
+    }
+    float extent = fmaxf(hi.x - lo.x, hi.y - lo.y);
+    float cells = (float)((1u << MORTON_BITS) - 1);
+    float scale = (extent > 0.0f) ? cells / extent : 0.0f;
+
+    int dynamic = 0;
+    for (int i = 0; i < n; i++) {
+        if (body_is_static(&w->bodies[i])) continue;
+        Vec2 p = w->position[i];
+        float x = fminf(fmaxf((p.x - lo.x) * scale, 0.0f), cells);
+        float y = fminf(fmaxf((p.y - lo.y) * scale, 0.0f), cells);
+        keys[dynamic].code = morton_spread((uint32_t)x) | (morton_spread((uint32_t)y) << 1);
+        keys[dynamic].index = i;
+        dynamic++;
+    }
+    qsort(keys, (size_t)dynamic, sizeof(MortonKey), compare_morton);
+
+    // Statics stay put; the k-th dynamic slot takes the k-th dynamic body in Z-order
+    for (int i = 0, k = 0; i < n; i++) {
+        from[i] = body_is_static(&w->bodies[i]) ? i : keys[k++].index;
+    }
+    for (int i = 0; i < n; i++) {
+        to[from[i]] = i;
+    }
+
+    permute(w->bodies, sizeof(Body), from, n, scratch);
+    permute(w->transforms, sizeof(BodyTransform), from, n, scratch);
+    permute(w->position, sizeof(Vec2), from, n, scratch);
+    permute(w->velocity, sizeof(Vec2), from, n, scratch);
+    permute(w->angle, sizeof(float), from, n, scratch);
+    permute(w->angular_velocity, sizeof(float), from, n, scratch);
+    permute(w->moving, sizeof(unsigned char), from, n, scratch);
+    permute(w->bound_radius, sizeof(float), from, n, scratch);
+    permute(w->body_id, sizeof(int), from, n, scratch);
+    permute(w->asleep, sizeof(unsigned char), from, n, scratch);
+    permute(w->sleep_time, sizeof(float), from, n, scratch);
+    permute(w->sleep_next, sizeof(int), from, n, scratch);
+    permute(w->sleep_position, sizeof(Vec2), from, n, scratch);
+    permute(w->sleep_angle, sizeof(float), from, n, scratch);
+    for (int i = 0; i < n; i++) {
+        w->body_index[w->body_id[i]] = i;
+        w->sleep_next[i] = to[w->sleep_next[i]];
+    }
+    if (w->actuator_body_index >= 0 && w->actuator_body_index < n) {
+        w->actuator_body_index = to[w->actuator_body_index];
+    }
+
+    remap_caches(w, to);
+    w->contact_count = 0;   // Detected again by the next step
+    broadphase_remap_bodies(w, to);
+    return 0;
 }
 
 // --- Public API ---
 
 // MAIN PHYSICS STEP FUNCTION 
 void world_step(World *w) {
-    // Step 1: Integrate velocities and positions (dynamics)
-    integrate_bodies(w);
-    
-    // Step 2: Iterative collision solver
-    // Re-detecting each iteration handles cascading collisions
-    static Collision collisions[MAX_COLLISIONS];
+    if (w->thread_ticks) {
+        memset(w->thread_ticks, 0, (size_t)task_pool_thread_count(w->tasks) * sizeof(Uint64));
+    }
+
+    // Everything asleep (or static): nothing can move, so skip the whole step
+    wake_disturbed_bodies(w);
+    if (!any_body_awake(w)) {
+        w->stats.candidate_pairs = 0;
+        w->stats.contacts = 0;
+        w->stats.solver_iterations = 0;
+        w->stats.awake_bodies = 0;
+        w->stats.islands = 0;
+        w->stats.solver_colors = 0;
+        w->stats.solver_islands = 0;
+        return;
+    }
+
+    // Regroup bodies in memory by position every reorder_interval steps
+    if (w->reorder_interval > 0 && ++w->steps_since_reorder >= w->reorder_interval) {
+        world_reorder_bodies(w);
+    }
+
+    // Step 1: Integrate velocities, then positions. Sequential impulse only solves
+    // velocities, so it first moves bodies with the velocities it solved last step and
+    // then adds gravity for this step's solve: a resting body ends every step at rest
+    // instead of at the -gravity * dt that would cancel next step's kick.
+    if (w->solver == SOLVER_SEQUENTIAL_IMPULSE) {
+        integrate_positions(w);
+        integrate_velocities(w);
+    } else {
+        integrate_velocities(w);
+        integrate_positions(w);
+    }
+
+    // Refresh the transform cache once for the new poses; later reads only recompute
+    // bodies moved by the solver
+    for (int i = 0; i < w->body_count; i++) {
+        world_get_transform(w, i);
+    }
+
+    // Step 2: Broadphase - candidate pairs from padded AABBs, once per step
+    w->stats.candidate_pairs = broadphase_update(w);
     
-    for (int iter = 0; iter < SOLVER_ITERATIONS; iter++) {
-        // Detect all body-body collisions fresh each iteration
-        int collision_count = detect_all_collisions(w, collisions, MAX_COLLISIONS);
-        
-        // Resolve each body-body collision
-        for (int i = 0; i < collision_count; i++) {
-            Body *a = &w->bodies[collisions[i].body_a];
-            Body *b = &w->bodies[collisions[i].body_b];
-            collision_resolve(a, b, &collisions[i]);
+    // Step 3: Iterative collision solver
+    // Narrowphase once; later iterations update the existing contacts from the new
+    // poses and only test pairs whose bodies were moved by the previous iteration
+    wake_touched_islands(w);
+    detect_contacts(w);
+
+    // Stops early once an iteration finds every contact within the tolerances: nothing
+    // left to push apart, and no impulse it applied changed a velocity noticeably
+    int iter = 0;
+    while (iter < w->solver_max_iterations) {
+        if (iter > 0) {
+            for (int i = 0; i < w->contact_count; i++) {
+                ContactManifold *m = &w->contacts[i];
+                contact_manifold_update(m, w->position[m->col.body_a], w->position[m->col.body_b]);
+            }
+            detect_new_contacts(w);
         }
+        // Resolve each body-body contact that is still touching, or that still holds
+        // impulse it may need to take back
+        SolverPass pass = { 0.0f, 0.0f, 0 };
+        solve_contacts(w, iter, &pass);
+        w->stats.contacts = pass.contacts;
+        float penetration_error = pass.penetration_error;
+        float velocity_error = pass.velocity_error;
+
         
         // Resolve boundaries last - ensures bodies stay inside world
         resolve_boundary_collisions(w);
+
+        iter++;
+        w->stats.penetration_error = penetration_error;
+        w->stats.velocity_error = velocity_error;
+        if (penetration_error <= w->solver_penetration_tolerance &&
+            velocity_error <= w->solver_velocity_tolerance) break;
+    }
+    w->stats.solver_iterations = iter;
+    if (w->contact_count > w->contact_peak) w->contact_peak = w->contact_count;
+
+    contact_cache_store(w);
+
+    // Step 4: Put resting islands to sleep
+    update_sleep(w);
+}
+
+static void render_pair_contacts(World *w, SDL_Renderer *r, int i, int j) {
+    if (w->bodies[i].shape.type != SHAPE_RECT || w->bodies[j].shape.type != SHAPE_RECT) return;
+    Collision col;
+    if (!detect_pair(w, i, j, &col)) return;
+    for (int k = 0; k < col.point_count; k++) {
+        render_contact_debug(r, col.points[k].point.x, col.points[k].point.y,
+                             col.normal.x, col.normal.y, col.points[k].penetration);
     }
 }
 
 void world_render_debug(World *w, SDL_Renderer *r) {
     for (int i = 0; i < w->body_count; i++) {
-        render_body_debug(r, &w->bodies[i], w->debug.show_velocity);
+        render_body_debug(r, &w->bodies[i], w->position[i], w->angle[i], w->velocity[i],
+                          w->debug.show_velocity);
     }
 
-    // Rect-rect contact debug: show contact point, normal, and penetration
+    // Rect-rect contact debug: show each manifold point, the normal, and its penetration.
+    // Pairs are detected afresh for the current poses, one at a time (nothing is stored).
     if (w->debug.show_contacts) {
-        Collision contacts[MAX_COLLISIONS];
-        int n = detect_all_collisions(w, contacts, MAX_COLLISIONS);
-        for (int i = 0; i < n; i++) {
-            Body *a = &w->bodies[contacts[i].body_a];
-            Body *b = &w->bodies[contacts[i].body_b];
-            if (a->shape.type == SHAPE_RECT && b->shape.type == SHAPE_RECT) {
-                render_contact_debug(r,
-                    contacts[i].contact.x, contacts[i].contact.y,
-                    contacts[i].normal.x, contacts[i].normal.y,
-                    contacts[i].penetration);
+        if (w->broadphase == BROADPHASE_BRUTE_FORCE) {
+            for (int i = 0; i < w->body_count; i++) {
+                for (int j = i + 1; j < w->body_count; j++) {
+                    if (!body_should_collide(&w->bodies[i], &w->bodies[j])) continue;
+                    render_pair_contacts(w, r, i, j);
+                }
+            }
+        } else {
+            for (int k = 0; k < w->pair_count; k++) {
+                render_pair_contacts(w, r, w->pairs[k].a, w->pairs[k].b);
             }
         }
     }
@@ -389,6 +1828,7 @@ float world_randf(World *w) {
 int world_spawn_grid(World *w, int rows, int cols, Vec2 origin, float spacing,
                      float radius, float mass, float restitution) {
     int added = 0;
+    world_reserve_bodies(w, w->body_count + rows * cols);  // One allocation; world_add_body retries on failure
     
     for (int row = 0; row < rows; row++) {
         for (int col = 0; col < cols; col++) {
@@ -397,7 +1837,7 @@ int world_spawn_grid(World *w, int rows, int cols, Vec2 origin, float spacing,
                 origin.y + row * spacing
             );
             
-            Body b = body_create_circle(pos, radius, mass, restitution);
+            Body b = body_create_circle(radius, mass, restitution);
             // Give each body a slightly different color based on position
             b.color = (SDL_Color){
                 (Uint8)(100 + (col * 30) % 156),
@@ -406,7 +1846,7 @@ int world_spawn_grid(World *w, int rows, int cols, Vec2 origin, float spacing,
                 255
             };
             
-            if (world_add_body(w, b) >= 0) {
+            if (world_add_body(w, b, pos) >= 0) {
                 added++;
             }
         }
@@ -419,6 +1859,7 @@ int world_spawn_random(World *w, int count, float x_min, float y_min,
                        float x_max, float y_max, float min_radius, float max_radius,
                        float min_restitution, float max_restitution) {
     int added = 0;
+    world_reserve_bodies(w, w->body_count + count);  // One allocation; world_add_body retries on failure
     
     for (int i = 0; i < count; i++) {
         // Random position within bounds (deterministic)
@@ -439,10 +1880,10 @@ int world_spawn_random(World *w, int count, float x_min, float y_min,
             255
         };
         
-        Body b = body_create_circle(vec2(x, y), radius, 1.0f, restitution);
+        Body b = body_create_circle(radius, 1.0f, restitution);
         b.color = color;
         
-        if (world_add_body(w, b) >= 0) {
+        if (world_add_body(w, b, vec2(x, y)) >= 0) {
             added++;
         }
     }
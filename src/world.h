@@ -2,12 +2,36 @@
 #define WORLD_H
 
 #include "body.h"
+#include "collision.h"
 #include "vec2.h"
+#include "task.h"
 #include <SDL.h>
+#include <stdlib.h>
 
-#define MAX_BODIES 256
-#define MAX_COLLISIONS 512    // Worst case: n*(n-1)/2 for 256 bodies
-#define SOLVER_ITERATIONS 6   // Tune: 4-8 typical for stable stacking
+#define WORLD_INITIAL_CAPACITY 16   // Bodies allocated by the first world_add_body without a reservation
+#define CONTACT_BUFFER_INITIAL 64   // First contact buffer allocation; buffers double when full
+#define SOLVER_ITERATIONS 6   // Default iteration cap. Tune: 4-8 typical for stable stacking
+#define SOLVER_PENETRATION_TOLERANCE 0.05f   // Default early-out: deepest contact penetration (pixels)...
+#define SOLVER_VELOCITY_TOLERANCE 1.0f       // ...and largest velocity change of the last iteration (pixels/s)
+
+#define SLEEP_LINEAR_VELOCITY 2.0f    // Bodies slower than this (pixels/s)...
+#define SLEEP_ANGULAR_VELOCITY 0.035f // ...and turning slower than this (rad/s, ~2 deg/s)...
+#define SLEEP_TIME 0.5f               // ...for this long (seconds), with their whole island, fall asleep
+
+#define MORTON_BITS 16                // Grid resolution per axis of the Z-order body sort
+
+#define NARROWPHASE_TASK_PAIRS 256    // Bin slots per narrowphase task (a multiple of the 8-pair SIMD batches)
+#define SOLVER_COLORS 32              // Contact colors of the colored solver (one bit each per body); more go serial
+#define SOLVER_TASK_CONTACTS 64       // Contacts per task when a color is solved on several threads
+
+// Resize heap array `ptr` to `capacity` elements. On failure the array is left as it
+// was and `failed` is set (shared by the world and broadphase buffers).
+#define RESIZE_ARRAY(ptr, capacity, failed) do {                                  \
+        void *resized_ = realloc((ptr), (size_t)(capacity) * sizeof(*(ptr)));     \
+        if (resized_) (ptr) = resized_; else (failed) = 1;                        \
+    } while (0)
+
+#include "broadphase.h"
 
 // === UNIT SYSTEM ===
 // Scale: 100 pixels = 1 meter
@@ -33,9 +57,142 @@ typedef struct {
     int show_normals;          // Draw collision normals (future)
 } DebugFlags;
 
+// Per-step counters for profiling and benchmarks
+typedef struct {
+    int candidate_pairs;       // Pairs handed to the narrowphase this step
+    int contacts;              // Body-body contacts found in the last solver iteration
+    int solver_iterations;     // Solver iterations run (<= solver_max_iterations)
+    float penetration_error;   // Deepest contact penetration seen by the last iteration (pixels)
+    float velocity_error;      // Largest contact velocity change made by the last iteration (pixels/s)
+    int awake_bodies;          // Dynamic bodies simulated after this step (not asleep)
+    int islands;               // Awake islands (bodies linked by contacts) this step; counted only
+                               // while sleeping or profiling is on, 0 otherwise
+    int solver_colors;         // Contact colors of the last colored solver pass (0 = coloring off)
+    int solver_islands;        // Contact islands the last solver pass ran as tasks (0 = not island-parallel)
+} WorldStats;
+
+// Accumulated impulse of a contact at the end of a step, keyed by body pair and feature
 typedef struct {
-    Body bodies[MAX_BODIES];
+    int body_a;
+    int body_b;
+    int feature;
+    float normal_impulse;
+    int matched;          // Claimed by a contact detected this step
+} ContactCacheEntry;
+
+// Shape combination of a body pair (either order)
+typedef enum {
+    SHAPE_PAIR_CIRCLE_CIRCLE,
+    SHAPE_PAIR_CIRCLE_RECT,
+    SHAPE_PAIR_RECT_RECT,
+    SHAPE_PAIR_COUNT
+} ShapePair;
+
+// Candidate pairs binned by shape combination, so each bin runs through one
+// homogeneous narrowphase kernel (see detect_contacts). Heap buffers sized by the pair list.
+typedef struct {
+    int *slot;            // Per candidate pair: its slot in the bins, -1 = skipped
+    int *body_a;          // Per slot: the pair's bodies; bin t owns slots [start[t], start[t] + count[t])
+    int *body_b;
+    Collision *results;   // Per slot: narrowphase output, point_count = 0 when apart
+    int *sat_axis;        // Per slot: SAT axis hint of rect-rect pairs (see SatAxisCacheEntry)
+    int start[SHAPE_PAIR_COUNT];
+    int count[SHAPE_PAIR_COUNT];
+    int capacity;         // Pairs every buffer can hold
+} NarrowphaseBatches;
+
+// Largest errors and contacts solved by (part of) one solver iteration
+typedef struct {
+    float penetration_error;
+    float velocity_error;
+    int contacts;
+} SolverPass;
+
+// Contacts split into colors for the colored solver (world_set_solver_coloring): no
+// two contacts of a color share a dynamic body, so a color's contacts do not depend on
+// each other's results. Static bodies are never written by the solver and do not count.
+// Heap buffers sized by the contact list (body_colors by the body capacity).
+typedef struct {
+    int *color;                      // Per contact: its color, SOLVER_COLORS = overflow
+    int *order;                      // Contact indices grouped by color, in contact order within a color
+    int capacity;                    // Contacts both buffers can hold
+    int start[SOLVER_COLORS + 2];    // Color c owns order[start[c], start[c + 1]); color SOLVER_COLORS is the overflow
+    int color_count;                 // Colors holding at least one contact (overflow excluded)
+    int dirty;                       // Contact list changed since it was colored
+    unsigned int *body_colors;       // Scratch, per body: bit c set = color c already moves this body
+} ContactColors;
+
+// One island of the parallel solver
+typedef struct {
+    int first;            // Into ContactIslands.order
+    int count;            // Contacts in the island
+    Uint64 ticks;         // SDL performance counter ticks spent solving it since the islands were built (profiling only)
+} ContactIsland;
+
+// Contacts split into islands for the parallel solver (world_set_threads): contacts
+// linked through dynamic bodies share an island, so no two islands move the same body
+// and each one is solved on its own, in contact order. Islands are rebuilt whenever the
+// contact list changes (at least once per step), largest first.
+// Heap buffers sized by the contact list (body_island by the body capacity).
+typedef struct {
+    int *island;                     // Per contact: its island (before sorting by size)
+    int *order;                      // Contact indices grouped by island, in contact order within an island
+    ContactIsland *islands;          // island_count of them, most contacts first
+    int capacity;                    // Contacts (and so islands) every buffer can hold
+    int island_count;
+    int dirty;                       // Contact list changed since the islands were built
+    int *body_island;                // Scratch, per body: island of a union-find root, -1 = none yet
+} ContactIslands;
+
+// SAT axis a rect-rect pair ended the last full narrowphase on, encoded as by
+// collision_detect_rects (separating axis, or SAT_AXIS_TOUCHING + least-overlap axis).
+// Tried first next step.
+typedef struct {
+    int body_a;
+    int body_b;
+    int axis;
+} SatAxisCacheEntry;
+
+// Z-order sort key of one dynamic body (world_reorder_bodies)
+typedef struct {
+    uint32_t code;   // Morton code of the body's grid cell
+    int index;
+} MortonKey;
+
+// Room for one element of any per-body array, so one scratch buffer can permute them all
+typedef union {
+    Body body;
+    BodyTransform transform;
+} BodySlot;
+
+typedef struct World {
+    // Per-body arrays (this one and every one marked "per body" below) are heap buffers
+    // holding body_capacity elements. They grow with world_reserve_bodies, or by doubling
+    // when world_add_body finds the world full, and are released by world_destroy.
+    Body *bodies;                  // Per body: the cold part (mass, shape, filter, color; world_get_body)
+    BodyTransform *transforms;     // Per body: rotation, corners and AABB (see world_get_transform)
     int body_count;
+    int body_capacity;
+
+    // Hot per-body state, one stream per field (structure of arrays): the integrator and
+    // the bounds pass sweep these without touching Body (see world_get_position and friends)
+    Vec2 *position;                // Per body: pixels (world coordinates)
+    Vec2 *velocity;                // Per body: pixels/second
+    float *angle;                  // Per body: radians
+    float *angular_velocity;       // Per body: radians/second
+    unsigned char *moving;         // Per body: dynamic and awake, i.e. simulated by the step
+    float *bound_radius;           // Per body: body_bound_radius of its shape when added
+
+    // Body ids: the index world_add_body returned. Indices only change when bodies are
+    // reordered (world_set_reordering); ids never do.
+    int *body_id;                  // Per body: index -> id
+    int *body_index;               // Per body: id -> index
+    int reorder_interval;          // Steps between Z-order reorders, 0 = never
+    int steps_since_reorder;
+    MortonKey *reorder_keys;       // Scratch, per body: sort keys of the dynamic bodies
+    int *reorder_from;             // Scratch, per body: new index -> old index
+    int *reorder_to;               // Scratch, per body: old index -> new index
+    BodySlot *reorder_slots;       // Scratch, per body: copy of the array being permuted
     Vec2 gravity;            // Gravity acceleration in pixels/s² (e.g., [0, 981.0] for Earth)
     float dt;                // Fixed timestep in seconds (e.g., 0.016667 for 60 Hz)
 
@@ -51,26 +208,214 @@ typedef struct {
     float bound_bottom;
     int bounds_enabled;
     
+    // Broadphase selection and state (see broadphase.h)
+    BroadphaseType broadphase;
+    StaticIndex statics;
+    SpatialHash spatial_hash;
+    SweepAndPrune sap;
+    AabbTree aabb_tree;
+    HierarchicalGrid hgrid;
+    BodyPair *pairs;                     // Candidate pairs for the current step (grows on demand)
+    int pair_count;
+    int pair_capacity;
+
+    SolverType solver;   // Contact solver (see collision.h)
+    int solver_max_iterations;           // Iteration cap per step
+    float solver_penetration_tolerance;  // Iterations stop once every contact penetrates less (pixels)...
+    float solver_velocity_tolerance;     // ...and the last iteration changed no contact velocity by more (pixels/s)
+    int solver_coloring;                 // Solve contacts color by color (see world_set_solver_coloring)
+    ContactColors colors;
+    ContactIslands islands;              // Uncolored solver on several threads (see world_set_threads)
+
+    // Contacts detected once per step and reused by every solver iteration, sorted by body pair.
+    // Heap buffers owned by the world: they grow on demand and are kept across steps, so
+    // a warmed-up world no longer allocates (released by world_destroy).
+    ContactManifold *contacts;
+    int contact_count;
+    int contact_capacity;
+    int contact_peak;                    // Most contacts held by a single step since world_init
+    Vec2 *solver_positions;              // Per body: position at the last contact pass
+    unsigned char *body_moved;           // Per body: moved since the last contact pass
+
+    // Impulses of last step's contacts, sorted by (body_a, body_b, feature).
+    // Each contact detected again this step starts from its points' impulses (warm start).
+    ContactCacheEntry *contact_cache;
+    int contact_cache_count;
+    int contact_cache_capacity;
+
+    NarrowphaseBatches batches;          // Scratch for the full narrowphase pass
+
+    // Worker threads for the grid pair search and the full narrowphase (world_set_threads).
+    // NULL = everything runs on the calling thread.
+    TaskPool *tasks;
+    PairBuffer *thread_pairs;            // One per thread of the pool
+    SolverPass *thread_passes;           // One per thread of the pool: colored solver errors
+    Uint64 *thread_ticks;                // One per thread of the pool: island solve ticks this step (profiling only)
+    int profiling;                       // Time island solves per thread (see world_set_profiling)
+
+    // SAT axes of last step's rect-rect candidate pairs, sorted by (body_a, body_b)
+    SatAxisCacheEntry *sat_cache;
+    int sat_cache_count;
+    int sat_cache_capacity;
+
+    // Sleeping: resting islands skip integration, detection and bounds until woken
+    int sleep_enabled;
+    int sleeper_count;                  // Bodies asleep now: none = the wake checks have nothing to do
+    unsigned char *asleep;              // Per body
+    float *sleep_time;                  // Per body: seconds it has been slow enough to sleep
+    int *sleep_next;                    // Per body: next member of a sleeping body's island (a ring, woken together)
+    Vec2 *sleep_position;               // Per body: pose it fell asleep in; changed from outside = wake
+    float *sleep_angle;
+    int *island_parent;                 // Scratch, per body: union-find forest of this step's islands
+    float *island_rest;                 // Scratch, per body: shortest sleep timer per island (at its root)
+
     // Debug visualization settings
     DebugFlags debug;
 
+    WorldStats stats;
+
     // Deterministic RNG state (xorshift32)
     uint32_t rng_state;
 } World;
 
-// Initialize world with gravity vector and fixed timestep
+// Initialize an empty world (no bodies, nothing allocated) with gravity vector and fixed timestep
 void world_init(World *w, Vec2 gravity, float dt);
 
+// Release the memory owned by the world (bodies, broadphase, contact and narrowphase
+// buffers). Call before dropping a world that has bodies, or before loading a scene into
+// it again.
+void world_destroy(World *w);
+
+// Make room for `capacity` bodies in every per-body buffer (never shrinks). scene_load
+// reserves exactly the scene's body count, so small worlds stay small.
+// Returns -1 if out of memory (the world keeps its old capacity).
+int world_reserve_bodies(World *w, int capacity);
+
 // Set world boundaries (left, top, right, bottom)
 void world_set_bounds(World *w, float left, float top, float right, float bottom);
 
-// Add a body to the world. Returns body index, or -1 if full
-int world_add_body(World *w, Body b);
+// Select the broadphase used for pair generation (default: BROADPHASE_SPATIAL_HASH)
+void world_set_broadphase(World *w, BroadphaseType type);
+
+// Rebuild the static body index (tree and cached dynamic-static pairs) at the next step,
+// and which bodies the step simulates. Statics are indexed once at load and the
+// broadphase only notices added bodies: call this after moving a static body or
+// changing whether a body is static (body_set_static).
+void world_invalidate_statics(World *w);
+
+// Select the contact solver (default: SOLVER_RELAXATION)
+void world_set_solver(World *w, SolverType type);
+
+// Iterate the contact solver at most max_iterations (>= 1) times per step, stopping
+// early once both errors fall within the tolerances. Tolerances < 0 never stop early.
+// Defaults: SOLVER_ITERATIONS, SOLVER_PENETRATION_TOLERANCE, SOLVER_VELOCITY_TOLERANCE.
+void world_set_solver_iterations(World *w, int max_iterations, float penetration_tolerance,
+                                 float velocity_tolerance);
+
+// Solve contacts color by color (default off): each color's contacts share no dynamic
+// body and run in parallel on the world's threads (world_set_threads), then contacts
+// beyond SOLVER_COLORS colors run serially. Still Gauss-Seidel, in a different order
+// than the plain pair order, so results differ from coloring off but do not depend on
+// the thread count.
+void world_set_solver_coloring(World *w, int enabled);
+
+// Split the broadphase pair search (spatial hash and hgrid), the full narrowphase and
+// the contact solver across `thread_count` threads, the calling one included (0 = one
+// per CPU core, 1 = single-threaded, the default). Work is cut into fixed chunks and
+// merged in pair order, and without coloring each contact island is solved as one task
+// in pair order, so results are bit-identical for any thread count. Reset by world_init.
+// Returns -1 if the threads cannot be started (the world stays single-threaded).
+int world_set_threads(World *w, int thread_count);
+
+// Time the island solver (default off): with it on, w->thread_ticks[t] holds the SDL
+// performance counter ticks thread t spent solving islands during the last step, and
+// each of w->islands.islands its own ticks summed over the iterations since the islands
+// were built, for load-balance measurements. Off, the solver reads no clock. Reset by
+// world_init.
+void world_set_profiling(World *w, int enabled);
+
+// Let resting islands fall asleep (default off). Sleepers keep zero velocity until
+// touched, which changes trajectories of slow bodies: opt in only where that is fine.
+// Disabling wakes every body.
+void world_set_sleeping(World *w, int enabled);
 
-// Get pointer to body at index (NULL if invalid)
+// Wake body `index` and the rest of its island. Bodies moved or given a velocity from
+// outside world_step wake on their own at the next step.
+void world_wake_body(World *w, int index);
+
+// Add a body at `position` (at rest, angle 0; see world_set_velocity and friends),
+// doubling the capacity when the world is full.
+// Returns body index, or -1 if out of memory
+int world_add_body(World *w, Body b, Vec2 position);
+
+// Current index of the body with id `id` (the index it was added at), -1 if invalid.
+// Code that keeps body indices across steps should keep ids when reordering is on.
+int world_find_body(const World *w, int id);
+
+// Every `interval` steps, sort the dynamic bodies in memory along a Z-order (Morton)
+// curve of their positions, so bodies close in space sit close in the per-body arrays.
+// Static bodies keep their indices. 0 = never (default).
+void world_set_reordering(World *w, int interval);
+
+// Z-order sort the dynamic bodies now. Indices held by the world (actuator_body_index,
+// sleep islands, contact and SAT caches, broadphase state) are remapped in place.
+// Results of later steps change with the new solver order. Works in per-body scratch
+// sized with the bodies, so it never allocates. Returns 0.
+int world_reorder_bodies(World *w);
+
+// Get pointer to the cold part of the body at index: mass, shape, filter and color
+// (NULL if invalid). Its pose and motion are read and set with the accessors below.
 Body* world_get_body(World *w, int index);
 
-// Advance simulation by one timestep (integrates velocities and positions)
+// Hot state of body `index`, kept in the world's per-body streams. Index must be valid.
+// Changing a sleeping body's state wakes it at the next step.
+static inline Vec2 world_get_position(const World *w, int index) {
+    return w->position[index];
+}
+
+static inline void world_set_position(World *w, int index, Vec2 position) {
+    w->position[index] = position;
+}
+
+static inline Vec2 world_get_velocity(const World *w, int index) {
+    return w->velocity[index];
+}
+
+static inline void world_set_velocity(World *w, int index, Vec2 velocity) {
+    w->velocity[index] = velocity;
+}
+
+static inline float world_get_angle(const World *w, int index) {
+    return w->angle[index];
+}
+
+static inline void world_set_angle(World *w, int index, float angle) {
+    w->angle[index] = angle;
+}
+
+static inline float world_get_angular_velocity(const World *w, int index) {
+    return w->angular_velocity[index];
+}
+
+static inline void world_set_angular_velocity(World *w, int index, float angular_velocity) {
+    w->angular_velocity[index] = angular_velocity;
+}
+
+// Cached rotation, corners and AABB of body `index`, recomputed first if the body
+// moved or turned since the last call. Index must be valid.
+static inline const BodyTransform *world_get_transform(World *w, int index) {
+    BodyTransform *xf = &w->transforms[index];
+    Vec2 p = w->position[index];
+    if (!xf->valid || xf->position.x != p.x || xf->position.y != p.y || xf->angle != w->angle[index]) {
+        body_compute_transform(&w->bodies[index], p, w->angle[index], xf);
+    }
+    return xf;
+}
+
+// Advance simulation by one timestep (integrates velocities and positions).
+// Reentrant: all state and scratch memory live in *w, so different worlds can be
+// stepped concurrently from different threads. Results depend only on *w (not on
+// the thread count of world_set_threads).
 void world_step(World *w);
 
 // Render all bodies with debug info based on w->debug flags